@@ -0,0 +1,37 @@
+/*======================================================================================================
+* FILE        : allocator.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the default TRACS_ALLOCATOR, backed by malloc/realloc/free.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdlib.h>
+#include "allocator.h"
+
+static void *heap_allocate(void *context, size_t size)
+{
+    (void)context;
+    return malloc(size);
+}
+
+static void *heap_reallocate(void *context, void *pointer, size_t old_size, size_t size)
+{
+    (void)context;
+    (void)old_size;
+    return realloc(pointer, size);
+}
+
+static void heap_release(void *context, void *pointer)
+{
+    (void)context;
+    free(pointer);
+}
+
+const TRACS_ALLOCATOR heap_allocator = { heap_allocate, heap_reallocate, heap_release, NULL };
@@ -0,0 +1,14 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include "tracsasm.h"
+
+extern const TRACS_ALLOCATOR heap_allocator;
+
+#define ALLOCATE(allocator, size)                       ((allocator)->allocate((allocator)->context, (size)))
+#define REALLOCATE(allocator, pointer, old_size, size)  ((allocator)->reallocate((allocator)->context, (pointer), (old_size), (size)))
+#define RELEASE(allocator, pointer)                     ((allocator)->release((allocator)->context, (pointer)))
+
+#endif
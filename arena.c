@@ -0,0 +1,190 @@
+/*======================================================================================================
+* FILE        : arena.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the arena TRACS_ALLOCATOR. Memory is bumped out of a list of blocks;
+*               growing the most recent allocation (the LINE array, the machine code, the symbol pool) is
+*               done in place while its block has room, and anything else is copied to the top. Blocks are
+*               only returned to malloc by arena_free().
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define ALIGN(size)     (((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+#define HEADER_SIZE     ALIGN(sizeof(ARENA_BLOCK))
+#define BLOCK_DATA(block)   ((unsigned char *)(block) + HEADER_SIZE)
+
+/*===============================================
+*   FUNCTION    :   new_block
+*   DESCRIPTION :   This function will add an empty block after the current one, big enough for size bytes and
+*                   at least twice the current block, so a growing array soon has a block to itself.
+*   ARGUMENTS   :   ARENA *arena, size_t size
+*   RETURNS     :   ARENA_BLOCK * (NULL if malloc failed)
+ *==============================================*/
+static ARENA_BLOCK *new_block(ARENA *arena, size_t size)
+{
+    size_t capacity = ARENA_BLOCK_SIZE;
+    if (arena->current != NULL && arena->current->capacity * 2 > capacity)
+        capacity = arena->current->capacity * 2;
+    if (size > capacity)
+        capacity = size;
+
+    ARENA_BLOCK *block = malloc(HEADER_SIZE + capacity);
+    if (block == NULL)
+        return NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    if (arena->current == NULL) {
+        block->next = arena->first;
+        arena->first = block;
+    }
+    else {
+        block->next = arena->current->next;
+        arena->current->next = block;
+    }
+    return block;
+}
+
+/*===============================================
+*   FUNCTION    :   arena_allocate
+*   DESCRIPTION :   This function will bump size bytes out of the current block, moving on to the next kept block
+*                   or a new one when it is full.
+*   ARGUMENTS   :   void *context (ARENA *), size_t size
+*   RETURNS     :   void *
+ *==============================================*/
+static void *arena_allocate(void *context, size_t size)
+{
+    ARENA *arena = context;
+    size = ALIGN(size ? size : 1);
+
+    ARENA_BLOCK *block = arena->current;
+    while (block != NULL && block->capacity - block->used < size) {
+        // Blocks kept from an earlier job are used in order; one that is too small is skipped
+        block = block->next;
+        if (block != NULL)
+            block->used = 0;
+    }
+    if (block == NULL) {
+        block = new_block(arena, size);
+        if (block == NULL)
+            return NULL;
+    }
+
+    arena->current = block;
+    void *pointer = BLOCK_DATA(block) + block->used;
+    block->used += size;
+    arena->last = pointer;
+    return pointer;
+}
+
+/*===============================================
+*   FUNCTION    :   arena_reallocate
+*   DESCRIPTION :   This function will grow the most recent allocation in place when its block has room, and
+*                   otherwise copy old_size bytes into a new allocation.
+*   ARGUMENTS   :   void *context (ARENA *), void *pointer, size_t old_size, size_t size
+*   RETURNS     :   void *
+ *==============================================*/
+static void *arena_reallocate(void *context, void *pointer, size_t old_size, size_t size)
+{
+    ARENA *arena = context;
+    if (pointer == NULL)
+        return arena_allocate(arena, size);
+
+    ARENA_BLOCK *block = arena->current;
+    if (pointer == arena->last && block != NULL) {
+        size_t offset = (size_t)((unsigned char *)pointer - BLOCK_DATA(block));
+        if (ALIGN(size ? size : 1) <= block->capacity - offset) {
+            block->used = offset + ALIGN(size ? size : 1);
+            return pointer;
+        }
+    }
+
+    void *moved = arena_allocate(arena, size);
+    if (moved != NULL)
+        memcpy(moved, pointer, old_size < size ? old_size : size);
+    return moved;
+}
+
+/*===============================================
+*   FUNCTION    :   arena_release
+*   DESCRIPTION :   This function does nothing; arena_reset() takes the memory back.
+*   ARGUMENTS   :   void *context, void *pointer
+*   RETURNS     :   VOID
+ *==============================================*/
+static void arena_release(void *context, void *pointer)
+{
+    (void)context;
+    (void)pointer;
+}
+
+/*===============================================
+*   FUNCTION    :   arena_init
+*   DESCRIPTION :   This function will create an empty arena. No memory is taken until the first allocation.
+*   ARGUMENTS   :   ARENA *arena
+*   RETURNS     :   VOID
+ *==============================================*/
+void arena_init(ARENA *arena)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->allocator.allocate = arena_allocate;
+    arena->allocator.reallocate = arena_reallocate;
+    arena->allocator.release = arena_release;
+    arena->allocator.context = arena;
+}
+
+/*===============================================
+*   FUNCTION    :   arena_reset
+*   DESCRIPTION :   This function will take back every allocation at once and keep the blocks for reuse.
+*   ARGUMENTS   :   ARENA *arena
+*   RETURNS     :   VOID
+ *==============================================*/
+void arena_reset(ARENA *arena)
+{
+    arena->current = arena->first;
+    if (arena->current != NULL)
+        arena->current->used = 0;
+    arena->last = NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   arena_free
+*   DESCRIPTION :   This function will return every block to malloc.
+*   ARGUMENTS   :   ARENA *arena
+*   RETURNS     :   VOID
+ *==============================================*/
+void arena_free(ARENA *arena)
+{
+    ARENA_BLOCK *block = arena->first;
+    while (block != NULL) {
+        ARENA_BLOCK *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena_init(arena);
+}
+
+/*===============================================
+*   FUNCTION    :   arena_capacity
+*   DESCRIPTION :   This function will add up the size of every block the arena holds.
+*   ARGUMENTS   :   const ARENA *arena
+*   RETURNS     :   size_t
+ *==============================================*/
+size_t arena_capacity(const ARENA *arena)
+{
+    size_t capacity = 0;
+    for (const ARENA_BLOCK *block = arena->first; block != NULL; block = block->next)
+        capacity += block->capacity;
+    return capacity;
+}
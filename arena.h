@@ -0,0 +1,39 @@
+#ifndef ARENA_H
+#define ARENA_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stddef.h>
+#include "tracsasm.h"
+
+#define ARENA_BLOCK_SIZE    (64 * 1024)
+#define ARENA_ALIGNMENT     16
+
+typedef struct arenaBlock {
+    struct arenaBlock *next;
+    size_t capacity;
+    size_t used;
+    // Data follows, ARENA_ALIGNMENT aligned
+} ARENA_BLOCK;
+
+/*
+ * Bump allocator for everything one assembly needs. Releasing a block does nothing; arena_reset() takes
+ * all of it back at once and keeps the blocks for the next job, so a worker that assembles many inputs
+ * settles at the memory of its largest one. One arena must only be used by one thread at a time.
+ */
+typedef struct arena {
+    TRACS_ALLOCATOR allocator;  // Hand this to the assembler
+    ARENA_BLOCK *first;
+    ARENA_BLOCK *current;
+    void *last;                 // Most recent allocation, which reallocate can grow in place
+} ARENA;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void arena_init(ARENA *arena);
+void arena_reset(ARENA *arena);
+void arena_free(ARENA *arena);
+size_t arena_capacity(const ARENA *arena);
+
+#endif
@@ -13,6 +13,25 @@
 *   24 April, 2024, V2.1 - Added error handling for invalid labels and instructions. Created Readme file.
 *   25 April, 2024, V2.2 - Finalized Issue with handling operand that needs to be added with the opcode.
 *   25 April, 2024, V2.3 - Added error handling invalid operation for instruction. 
+*   16 October, 2026, V3.0 - Single-pass assembly with forward-reference fixups.
+*   16 October, 2026, V3.1 - Labels resolved through the hashed symbol table.
+*   16 October, 2026, V3.2 - Mnemonics looked up through the shared perfect-hash opcode table.
+*   16 October, 2026, V3.3 - Growable LINE storage holding token offsets into the source text.
+*   16 October, 2026, V3.4 - Source text is memory-mapped through source.c.
+*   16 October, 2026, V3.5 - Machine code is returned in memory instead of written to translation.txt.
+*   16 October, 2026, V3.6 - Input file passed in by the caller, errors go to stderr, removed the debug pause.
+*   16 October, 2026, V3.7 - Reentrant core: assemble_program() reports into a diagnostics list and allocates
+*                            through a TRACS_ALLOCATOR; process_buffer() tokenizes text already in memory.
+*   16 October, 2026, V3.8 - assemble() and process_file() record per-phase --stats when given a STATS.
+*   16 October, 2026, V3.9 - assemble() takes the allocator from the caller, so workers can use an arena.
+*   16 October, 2026, V4.0 - Diagnostics carry the column of the offending token and are shown sorted and capped.
+*   16 October, 2026, V4.1 - assemble() runs the -O passes of optimizer.c between tokenizing and encoding.
+*   16 October, 2026, V4.2 - Operands too wide for the instruction are reported instead of masked.
+*   16 October, 2026, V4.3 - Instruction words and label operands are encoded by helpers that --watch shares.
+*   16 October, 2026, V4.4 - The -O passes only run on a program that assembled, which is then encoded again.
+*   16 October, 2026, V4.5 - token_number() stops past TOKEN_NUMBER_MAX instead of wrapping, so huge literals
+*                            are reported out of range.
+*   16 October, 2026, V4.6 - An ORG address outside the 11-bit address space is an error.
 ======================================================================================================*/
 /*===============================================
  *   HEADER FILES
@@ -21,327 +40,502 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
-#include <unistd.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
+#include "allocator.h"
 #include "assembler.h"
+#include "optimizer.h"
 
 /*===============================================
 *   FUNCTION    :   assemble
-*   DESCRIPTION :   This function assembles the script.asm file into formatted TRACS "C" code.
-*   ARGUMENTS   :   bool *success, char **lines, const char *filename
+*   DESCRIPTION :   This function assembles a source file ("-" for stdin) into TRACS machine code and prints
+*                   every diagnostic to stderr at once, in source order and capped at DIAGNOSTIC_LIMIT messages
+*                   (errors past the limit are still counted). It is the command-line entry point; embedders
+*                   should use tracs_assemble() instead.
+*                   All memory comes from allocator (NULL for malloc), and on success the caller owns code
+*                   and must release it with freeMachineCode(). With stats, every phase is timed and the
+*                   allocations are counted on their way to allocator, so stats must outlive code.
+*                   An optimize level above OPTIMIZE_NONE then removes redundant instructions from a program
+*                   that assembled without errors, and encodes it again.
+*   ARGUMENTS   :   const char *filename, MACHINE_CODE *code, const TRACS_ALLOCATOR *allocator, int optimize,
+*                   STATS *stats (NULL for none)
 *   RETURNS     :   int
  *==============================================*/
-int assemble(void) {
-    // Initialization...
+int assemble(const char *filename, MACHINE_CODE *code, const TRACS_ALLOCATOR *allocator, int optimize, STATS *stats) {
     int success = 0;
-    unsigned int address = 0x000;
-    unsigned int temp_address = 0x000;
-    bool hasEOP = false;
-    int label_count = 0;
-    int line_count;
-    LABEL labels[MAX_LINES];
-
-    // Step 1: Read the assembly code from the array and store it in an array of LINE structs
-    LINE *lines = process_file("script.asm", &line_count);
-    if (lines == NULL) {
-        printf("Error reading lines\n");
-        return success;
+    PROGRAM program;
+    DIAGNOSTICS diagnostics;
+    if (allocator == NULL)
+        allocator = &heap_allocator;
+    if (stats != NULL) {
+        stats->backing = allocator;
+        allocator = &stats->allocator;
     }
+    diagnostics_init(&diagnostics, allocator);
+    diagnostics.limit = DIAGNOSTIC_LIMIT;
 
-    // Printing all the lines 
-    for (int i = 0; i < line_count; i++)
-    {
-        printf("Label: %s, Operation: %s, Operand: %s\n", lines[i].label, lines[i].operation, lines[i].operand);
-    }
-    getchar();
-    // Step 2: If set, load address, else set to 0x000
-    set_address(&address, line_count, lines);
-    temp_address = address; // Saving address to temp_address for later use (Labels)
-
-    // Step 3: Create a label array and populate it with labels and their addresses
-    for (int i = 1; i < line_count; i++) {
-        OPOBJ op = get_opcode(lines[i].operation);
-        if(strcmp(lines[i].label, "EOP") == 0 || strcmp(lines[i].operation, "EOP") == 0) 
-            hasEOP = true;
-        if (lines[i].label[0] != '\0') {
-            strcpy(labels[label_count].label, lines[i].label);
-            labels[label_count].address = temp_address;
-            label_count++;
-        }
-        temp_address += 2; // Increment the address for each line
-    }
-    if(!hasEOP) 
-    {
-        printf("Error: No EOP found\n");
-        free(lines);
-        return success;
-    }
+    // Step 1: Read the assembly code and split it into LINE tokens
+    if (process_file(filename, allocator, &program, &diagnostics, stats)) {
+        // Step 2: Encode it
+        stats_begin(stats, STATS_ENCODE);
+        success = assemble_program(&program, code, &diagnostics);
+        stats_end(stats, program.line_count, success ? code->count : 0);
 
-    // Step 4: Check for invalid labels as operands...
-    bool hasInvalidLabel = false;
-    for (int i = 1; i < line_count; i++) {
-        if (lines[i].operand[0] != '\0' && strncmp(lines[i].operand, "0x", 2) != 0) {
-            int labelFound = 0;
-            for (int j = 0; j < label_count; j++) {
-                if (strcmp(lines[i].operand, labels[j].label) == 0) {
-                    labelFound = 1;
-                    break;
-                }
-            }
-            if (!labelFound) {
-                hasInvalidLabel = true;
-                printf("Error: Unknown Label: %s\n", lines[i].operand);
-            }
+        // Step 3: Drop redundant instructions from a program without errors; labels move when it is encoded again
+        if (success && optimize > OPTIMIZE_NONE) {
+            stats_begin(stats, STATS_OPTIMIZE);
+            optimize_program(&program, optimize, code, &diagnostics);
+            stats_end(stats, program.line_count, code->count);
         }
+        free_program(&program);
     }
 
-    if(hasInvalidLabel) {
-        free(lines);
-        return success;
+    diagnostics_sort(&diagnostics);
+    print_diagnostics(&diagnostics, strcmp(filename, "-") == 0 ? "<stdin>" : filename, stderr);
+    diagnostics_free(&diagnostics);
+    return success;
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_program
+*   DESCRIPTION :   This function encodes tokenized lines into TRACS machine code.
+*                   Assembly is done in a single pass: every line is encoded as it is read, label
+*                   uses that are not yet defined are recorded in a fixup list and patched as soon
+*                   as the label is defined. Anything still unresolved at the end is an unknown label.
+*                   Problems are added to diagnostics; nothing is printed. All memory comes from the
+*                   program's allocator. On success the caller owns code and must release it with
+*                   freeMachineCode().
+*   ARGUMENTS   :   const PROGRAM *program, MACHINE_CODE *code, DIAGNOSTICS *diagnostics
+*   RETURNS     :   bool
+ *==============================================*/
+bool assemble_program(const PROGRAM *program, MACHINE_CODE *code, DIAGNOSTICS *diagnostics) {
+    // Initialization...
+    const TRACS_ALLOCATOR *allocator = program->allocator;
+    unsigned int address = 0x000;
+    bool hasEOP = false;
+    bool outOfRange = false;
+    int errors = diagnostics->errors;
+    int fixup_count = 0;
+    int line_count = program->line_count;
+    const LINE *lines = program->lines;
+    SYMTAB symbols;
+
+    // Every line emits at most one instruction and references at most one label
+    bool allocated = initMachineCode(code, line_count, allocator);
+    FIXUP *fixups = ALLOCATE(allocator, (line_count > 0 ? line_count : 1) * sizeof(FIXUP));
+    allocated = symtab_init(&symbols, line_count, allocator) && allocated && fixups != NULL;
+    if (!allocated) {
+        report(diagnostics, TRACS_ERROR, 0, "Memory allocation failed");
+        freeMachineCode(code);
+        if (fixups != NULL)
+            RELEASE(allocator, fixups);
+        symtab_free(&symbols);
+        return false;
     }
 
-    bool hasInvalidOperation = false;
-    for (int i = 1; i < line_count; i++) {
-        OPOBJ op = get_opcode(lines[i].operation);
-        if (op.opcode == -1) 
-        {
-            printf("Invalid instruction: %s\n", lines[i].label);
-            hasInvalidOperation = true;
+    // Walk the lines once, defining labels and emitting instructions as we go
+    for (int i = 0; i < line_count; i++) {
+        const LINE *line = &lines[i];
+
+        // ORG sets the location counter for the code that follows it
+        if (token_equals(program, line->label, "ORG")) {
+            unsigned long origin;
+            if (!token_number(program, line->operation, &origin) || origin >= TRACS_MEMORY_SIZE)
+                report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, line->operation), "Invalid ORG address: %.*s",
+                          TOKEN_ARGS(program, line->operation));
+            else
+                address = (unsigned int)origin;
+            continue;
         }
-        // There is also another condition, only BR, BRE, BRNE, BRGT, BRLT can have labels as operands
-        if(strcmp(lines[i].operation, "BR") != 0 && strcmp(lines[i].operation, "BRE") != 0 && strcmp(lines[i].operation, "BRNE") != 0 && strcmp(lines[i].operation, "BRGT") != 0 && strcmp(lines[i].operation, "BRLT") != 0)
-        {
-            if(lines[i].operand[0] != '\0' && strncmp(lines[i].operand, "0x", 2) != 0)
-            {
-                int labelFound = 0;
-                for (int j = 0; j < label_count; j++) {
-                    if (strcmp(lines[i].operand, labels[j].label) == 0) {
-                        labelFound = 1;
-                        break;
-                    }
-                }
-                if (labelFound) {
-                    printf("Error: Invalid operand for instruction: %s\n", lines[i].operation);
-                    hasInvalidOperation = true;
-                }
+        if (token_equals(program, line->label, "EOP") || token_equals(program, line->operation, "EOP")) 
+            hasEOP = true;
+        if (address >= TRACS_MEMORY_SIZE && !outOfRange) {
+            outOfRange = true;
+            report_at(diagnostics, TRACS_WARNING, line->number, token_column(program, line->label.length != 0 ? line->label : line->operation),
+                      "Address 0x%03x is outside the 11-bit address space", address);
+        }
+
+        // A label definition resolves every pending use of it
+        if (line->label.length != 0) {
+            bool duplicate;
+            int sym = symtab_define(&symbols, token_text(program, line->label), line->label.length, address, i, &duplicate);
+            if (sym == -1) {
+                report(diagnostics, TRACS_ERROR, line->number, "Memory allocation failed");
+                break;
+            }
+            if (duplicate) {
+                report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, line->label), "Duplicate Label: %.*s (first defined on line %u)",
+                       TOKEN_ARGS(program, line->label), lines[symbols.symbols[sym].line].number);
+            }
+            else {
+                for (int j = symbols.symbols[sym].fixups; j != -1; j = fixups[j].next)
+                    resolve_fixup(program, &fixups[j], code, address, diagnostics);
+                symbols.symbols[sym].fixups = -1;
             }
         }
-    }
-    if(hasInvalidOperation) {
-        free(lines);
-        return success;
-    }
-        
-    // Open file for writing...
-    FILE *output_file = fopen("translation.txt", "w"); 
-    if (output_file == NULL) {
-        printf("Error opening output file\n");
-        free(lines);
-        return success;
-    }
 
-    // Print formatted TRACS code...
-    for (int i = 1; i < line_count; i++) {
-        bool flag = false;
-        OPOBJ op = get_opcode(lines[i].operation);
-        if (op.opcode == -1) 
+        const MNEMONIC *op = mnemonic_lookup(token_text(program, line->operation), line->operation.length);
+        if (op == NULL) 
         {
-            printf("Invalid instruction: %s\n", lines[i].operation);
+            if (line->operation.length == 0)
+                report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, line->label), "Missing instruction after label %.*s",
+                          TOKEN_ARGS(program, line->label));
+            else
+                report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, line->operation), "Invalid instruction: %.*s",
+                          TOKEN_ARGS(program, line->operation));
+            address += 2;
             continue;
         }
-        int concat = 0x0000;
-        if(op.addBoolean)
-        {
-            op.opcode = op.opcode << 8;
-            unsigned long operand_int = strtoul(lines[i].operand + 2, NULL, 16); // Skip "0x" prefix
-            concat = op.opcode | operand_int; 
-            int first = (concat >> 8) & 0xFF;
-            int second = concat & 0xFF;
-            // Checking to see if it is a branch operation
-
-            if(strcmp(lines[i].operation, "BR") == 0 || strcmp(lines[i].operation, "BRE") == 0 || strcmp(lines[i].operation, "BRNE") == 0 || strcmp(lines[i].operation, "BRGT") == 0 || strcmp(lines[i].operation, "BRLT") == 0)
-            {
-                // We know that the branch points to a label. So instead of second, we will point to the label address
-                // Looping through each label to find the address of the label. We compare label name
-                for (int j = 0; j < label_count; j++) 
-                {
-                    if (strcmp(lines[i].operand, labels[j].label) == 0) {
-                        fprintf(output_file, "0x%02x 0x%02x\t0x%02x 0x%02x\n", address, first, address + 1, labels[j].address);
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                fprintf(output_file, "0x%02x 0x%02x\t0x%02x 0x%02x\n", address, first, address + 1, second);
-            }
+
+        TOKEN operand = line->operand;
+        unsigned long operand_int = 0;
+        if (operand.length != 0 && token_is_number(program, operand)) {
+            if (!token_number(program, operand, &operand_int) && operand_int <= TOKEN_NUMBER_MAX)
+                report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, operand), "Invalid operand: %.*s", TOKEN_ARGS(program, operand));
+            else if (operand_int > operand_limit(op))
+                report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, operand), "Operand out of range: %.*s (at most 0x%lx)",
+                          TOKEN_ARGS(program, operand), operand_limit(op));
         }
-        else
-        {
-            flag = true;
-            fprintf(output_file, "0x%02x 0x%02x\t", address, op.opcode);
+        if (!appendMachineCode(code, address, encode_instruction(op, operand_int))) {
+            report(diagnostics, TRACS_ERROR, line->number, "Memory allocation failed");
+            break;
         }
-        if(flag)
-        {
-            int labelFound = 0;
-            for (int j = 0; j < label_count; j++) {
-                if (strcmp(lines[i].operand, labels[j].label) == 0) {
-                    fprintf(output_file, "0x%02x 0x%02x\n", address + 1, labels[j].address);
-                    labelFound = 1;
-                    break;
-                }
+        if (operand.length != 0 && !token_is_number(program, operand)) {
+            // Label operand: use it now if it is already defined, otherwise patch it later
+            int sym = symtab_intern(&symbols, token_text(program, operand), operand.length);
+            if (sym == -1) {
+                report(diagnostics, TRACS_ERROR, line->number, "Memory allocation failed");
+                break;
             }
-            if (!labelFound && lines[i].operand[0] == '\0') {
-                fprintf(output_file, "0x%02x 0x00\n", address + 1);
-                labelFound = 1;
+            FIXUP fixup = { i, code->count / 2 - 1, sym, op->isBranch, -1 };
+            if (symbols.symbols[sym].defined) {
+                resolve_fixup(program, &fixup, code, symbols.symbols[sym].address, diagnostics);
             }
-            if (!labelFound && strncmp(lines[i].operand, "0x", 2) == 0) {
-                int k = 2;
-                while (lines[i].operand[k] != '\0') {
-                    if (!isdigit(lines[i].operand[k])) {
-                        break;
-                    }
-                    k++;
-                }
-                if (lines[i].operand[k] == '\0') {
-                    fprintf(output_file, "0x%02x %s\n", address + 1, lines[i].operand);
-                    labelFound = 1;
-                }
-            }
-            if (!labelFound) {
-                fprintf(output_file, "Unknown Label: %s Writing opcode %s\n", lines[i].operand, lines[i].operation);
+            else {
+                fixup.next = symbols.symbols[sym].fixups;
+                symbols.symbols[sym].fixups = fixup_count;
+                fixups[fixup_count++] = fixup;
             }
         }
-        address += 2;
+        address += 2; // Increment the address for each line
+    }
+
+    // Anything still pending was never defined
+    for (int j = 0; j < fixup_count; j++) {
+        if (!symbols.symbols[fixups[j].symbol].defined)
+            report_at(diagnostics, TRACS_ERROR, lines[fixups[j].line].number, token_column(program, lines[fixups[j].line].operand),
+                      "Unknown Label: %.*s", TOKEN_ARGS(program, lines[fixups[j].line].operand));
     }
+    if(!hasEOP) 
+        report(diagnostics, TRACS_ERROR, 0, "No EOP found");
 
-    // Close the output file
-    fclose(output_file);
-    // Free allocated memory...
-    free(lines);
-    return 1;
+    RELEASE(allocator, fixups);
+    symtab_free(&symbols);
+    if (diagnostics->errors != errors) {
+        freeMachineCode(code);
+        return false;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   resolve_fixup
+*   DESCRIPTION :   This function will patch a label address into an emitted instruction. Only branch operations
+*                   may take a label as operand; any other operation is reported as an invalid operand.
+*   ARGUMENTS   :   const PROGRAM *program, const FIXUP *fixup, MACHINE_CODE *code, unsigned int address,
+*                   DIAGNOSTICS *diagnostics
+*   RETURNS     :   bool
+ *==============================================*/
+bool resolve_fixup(const PROGRAM *program, const FIXUP *fixup, MACHINE_CODE *code, unsigned int address, DIAGNOSTICS *diagnostics)
+{
+    const LINE *line = &program->lines[fixup->line];
+    if (!fixup->isBranch) {
+        report_at(diagnostics, TRACS_ERROR, line->number, token_column(program, line->operand), "Invalid operand for instruction: %.*s (only branches take a label)",
+               TOKEN_ARGS(program, line->operation));
+        return false;
+    }
+    encode_target(code, fixup->word, address);
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   encode_instruction
+*   DESCRIPTION :   This function will build the 16-bit word of an instruction: the opcode in the high byte and the
+*                   operand in the bits below it, masked to what the instruction holds. A label operand is 0 here
+*                   and is filled in by encode_target().
+*   ARGUMENTS   :   const MNEMONIC *op, unsigned long operand
+*   RETURNS     :   unsigned int
+ *==============================================*/
+unsigned int encode_instruction(const MNEMONIC *op, unsigned long operand)
+{
+    return (unsigned int)op->opcode << 8 | (unsigned int)(operand & operand_limit(op));
+}
+
+/*===============================================
+*   FUNCTION    :   encode_target
+*   DESCRIPTION :   This function will write a branch target into an instruction already in the machine code,
+*                   replacing whatever target it had.
+*   ARGUMENTS   :   MACHINE_CODE *code, int word, unsigned int address
+*   RETURNS     :   VOID
+ *==============================================*/
+void encode_target(MACHINE_CODE *code, int word, unsigned int address)
+{
+    // 11-bit address bus: the top three bits share the opcode byte
+    code->bytes[2 * word].value = (code->bytes[2 * word].value & ~0x07) | ((address >> 8) & 0x07);
+    code->bytes[2 * word + 1].value = address & 0xFF;
+}
+
+/*===============================================
+*   FUNCTION    :   operand_limit
+*   DESCRIPTION :   This function will return the largest operand an instruction can hold: 11 bits for a memory
+*                   address or branch target, 8 for everything else.
+*   ARGUMENTS   :   const MNEMONIC *op
+*   RETURNS     :   unsigned long
+ *==============================================*/
+unsigned long operand_limit(const MNEMONIC *op)
+{
+    return op->kind == OPERAND_ADDRESS || op->kind == OPERAND_LABEL ? 0x7FF : 0xFF;
 }
 
 /*===============================================
 *   FUNCTION    :   set_address
 *   DESCRIPTION :   This function will set the address of the instruction.
-*   ARGUMENTS   :   unsigned int *address
+*   ARGUMENTS   :   unsigned int *address, const PROGRAM *program
 *   RETURNS     :   VOID
  *==============================================*/
-void set_address(unsigned int *address, int line_count, LINE *lines)
+void set_address(unsigned int *address, const PROGRAM *program)
 {
-    bool orgFound = false;
-    for (int i = 0; i < line_count; i++)
+    for (int i = 0; i < program->line_count; i++)
     {
-        if (strcmp(lines[i].label, "ORG") == 0)
+        unsigned long origin;
+        if (token_equals(program, program->lines[i].label, "ORG") && token_number(program, program->lines[i].operation, &origin) &&
+            origin < TRACS_MEMORY_SIZE)
         {
-            orgFound = true;
-            *address = strtol(lines[i].operation, NULL, 0);
+            *address = (unsigned int)origin;
             return;
         }
     }
-    if(orgFound == false)
-        *address = 0x000;
+    *address = 0x000;
+}
+
+/*===============================================
+*   FUNCTION    :   token_equals
+*   DESCRIPTION :   This function will compare a token with a NUL-terminated string.
+*   ARGUMENTS   :   const PROGRAM *program, TOKEN token, const char *text
+*   RETURNS     :   bool
+ *==============================================*/
+bool token_equals(const PROGRAM *program, TOKEN token, const char *text)
+{
+    return strlen(text) == token.length && memcmp(token_text(program, token), text, token.length) == 0;
+}
+
+/*===============================================
+*   FUNCTION    :   token_is_number
+*   DESCRIPTION :   This function will tell whether an operand is a literal ("0x" prefix) rather than a label.
+*   ARGUMENTS   :   const PROGRAM *program, TOKEN token
+*   RETURNS     :   bool
+ *==============================================*/
+bool token_is_number(const PROGRAM *program, TOKEN token)
+{
+    const char *text = token_text(program, token);
+    return token.length >= 2 && text[0] == '0' && text[1] == 'x';
+}
+
+/*===============================================
+*   FUNCTION    :   token_number
+*   DESCRIPTION :   This function will parse a hexadecimal ("0x" prefix) or decimal token. Reading stops as soon
+*                   as the value passes TOKEN_NUMBER_MAX, so a long literal cannot wrap around to a small one.
+*   ARGUMENTS   :   const PROGRAM *program, TOKEN token, unsigned long *value
+*   RETURNS     :   bool (false if the token is empty, has invalid digits or is too large; *value holds the digits
+*                   read so far, or TOKEN_NUMBER_MAX + 1 if the value is too large)
+ *==============================================*/
+bool token_number(const PROGRAM *program, TOKEN token, unsigned long *value)
+{
+    const char *text = token_text(program, token);
+    unsigned int i = 0;
+    unsigned int base = 10;
+    *value = 0;
+    if (token_is_number(program, token)) {
+        base = 16;
+        i = 2;
+    }
+    if (i == token.length)
+        return false;
+    for (; i < token.length; i++) {
+        unsigned int digit;
+        char c = text[i];
+        if (c >= '0' && c <= '9')       digit = c - '0';
+        else if (c >= 'a' && c <= 'f')  digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')  digit = c - 'A' + 10;
+        else                            return false;
+        if (digit >= base)
+            return false;
+        *value = *value * base + digit;
+        if (*value > TOKEN_NUMBER_MAX) {
+            *value = TOKEN_NUMBER_MAX + 1;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   token_column
+*   DESCRIPTION :   This function will return the 1-based column a token starts at. Lines only keep their number,
+*                   so this looks back for the start of the line; it is only called when something is reported.
+*   ARGUMENTS   :   const PROGRAM *program, TOKEN token
+*   RETURNS     :   unsigned int
+ *==============================================*/
+unsigned int token_column(const PROGRAM *program, TOKEN token)
+{
+    const char *text = program->source.text;
+    unsigned int start = token.offset;
+    while (start > 0 && text[start - 1] != '\n')
+        start--;
+    return token.offset - start + 1;
 }
 
 /*===============================================
 *   FUNCTION    :   process_file
-*   DESCRIPTION :   This function will read the assembly code from the file and store it in an array of LINE structs.
-*   ARGUMENTS   :   const char *filename, int *line_count
-*   RETURNS     :   LINE *
+*   DESCRIPTION :   This function will read the assembly code from the file ("-" for stdin) and tokenize it,
+*                   timing the two steps into stats unless it is NULL.
+*   ARGUMENTS   :   const char *filename, const TRACS_ALLOCATOR *allocator, PROGRAM *program, DIAGNOSTICS *diagnostics,
+*                   STATS *stats
+*   RETURNS     :   bool
  *==============================================*/
-LINE* process_file(const char *filename, int *line_count) {
-    // Open the file
-    FILE *fp = fopen(filename, "r");
-    if (fp == NULL) {
-        printf("Error opening file %s\n", filename);
-        return NULL;
+bool process_file(const char *filename, const TRACS_ALLOCATOR *allocator, PROGRAM *program, DIAGNOSTICS *diagnostics, STATS *stats) {
+    memset(program, 0, sizeof(*program));
+    program->allocator = allocator;
+
+    // Map the file (or stream it, for pipes); tokens point straight into this text
+    stats_begin(stats, STATS_READ);
+    bool opened = source_open(filename, &program->source);
+    stats_end(stats, 0, program->source.size);
+    if (!opened) {
+        report(diagnostics, TRACS_ERROR, 0, "Cannot open file: %s", strerror(errno));
+        return false;
     }
 
-    // Allocate memory for the array of lines
-    LINE *lines = malloc(MAX_LINES * sizeof(LINE));
-    if (lines == NULL) {
-        printf("Memory allocation failed\n");
-        fclose(fp);
-        return NULL;
+    stats_begin(stats, STATS_TOKENIZE);
+    size_t size = program->source.size;
+    bool tokenized = tokenize_program(program, diagnostics);
+    stats_end(stats, program->line_count, size);
+    return tokenized;
+}
+
+/*===============================================
+*   FUNCTION    :   process_buffer
+*   DESCRIPTION :   This function will tokenize assembly code already in memory. The text is not copied and
+*                   must outlive the program.
+*   ARGUMENTS   :   const char *text, size_t size, const TRACS_ALLOCATOR *allocator, PROGRAM *program,
+*                   DIAGNOSTICS *diagnostics
+*   RETURNS     :   bool
+ *==============================================*/
+bool process_buffer(const char *text, size_t size, const TRACS_ALLOCATOR *allocator, PROGRAM *program, DIAGNOSTICS *diagnostics) {
+    memset(program, 0, sizeof(*program));
+    program->allocator = allocator;
+    program->source.text = text;
+    program->source.size = size;
+    return tokenize_program(program, diagnostics);
+}
+
+/*===============================================
+*   FUNCTION    :   tokenize_program
+*   DESCRIPTION :   This function will split every non-empty line of the program's source into label, operation
+*                   and operand tokens. Tokens are offsets into the source text, so no line is ever copied,
+*                   and the LINE array grows with the input.
+*   ARGUMENTS   :   PROGRAM *program, DIAGNOSTICS *diagnostics
+*   RETURNS     :   bool
+ *==============================================*/
+bool tokenize_program(PROGRAM *program, DIAGNOSTICS *diagnostics) {
+    if (program->source.size > UINT_MAX) {
+        report(diagnostics, TRACS_ERROR, 0, "Source is larger than 4 GB");
+        free_program(program);
+        return false;
     }
 
-    // Read the file LINE by LINE
-    char LINE[MAX_LINE_LENGTH];
-    *line_count = 0;
-    while (fgets(LINE, sizeof(LINE), fp))
+    // Tokenize LINE by LINE
+    const char *text = program->source.text;
+    const char *p = text;
+    const char *end = text + program->source.size;
+    unsigned int number = 0;
+    while (p < end)
     {
-        // Remove comments
-        char *comment = strchr(LINE, ';');
-        if (comment != NULL)
-            *comment = '\0'; // Terminate the string at the comment position
-
-        // Remove leading and trailing whitespace
-        char *start = LINE;
-        while (*start == ' ' || *start == '\t') start++;
-        char *end = start + strlen(start) - 1;
-        while (end > start && (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r')) end--;
-        *(end + 1) = '\0';
+        TOKEN fields[3] = {{0, 0}, {0, 0}, {0, 0}};
+        int field_count = 0;
+        number++;
+        while (p < end && *p != '\n')
+        {
+            // Remove comments
+            if (*p == ';') {
+                while (p < end && *p != '\n') p++;
+                break;
+            }
+            if (isspace((unsigned char)*p)) {
+                p++;
+                continue;
+            }
+            const char *start = p;
+            while (p < end && *p != '\n' && *p != ';' && !isspace((unsigned char)*p)) p++;
+            if (field_count < 3) {
+                fields[field_count].offset = (unsigned int)(start - text);
+                fields[field_count].length = (unsigned int)(p - start);
+                field_count++;
+            }
+        }
+        if (p < end) p++; // Skip the newline
 
         // Skip empty lines
-        if (strlen(start) == 0)
+        if (field_count == 0)
             continue;
 
-        // Parse the LINE and store it in the array
-        if (strlen(start) > 0)
-        {
-            sscanf(start, "%s %s %s", lines[*line_count].label, lines[*line_count].operation, lines[*line_count].operand);
-            (*line_count)++;
+        if (program->line_count == program->line_capacity) {
+            int line_capacity = program->line_capacity ? program->line_capacity * 2 : 256;
+            LINE *lines = REALLOCATE(program->allocator, program->lines, program->line_capacity * sizeof(LINE), line_capacity * sizeof(LINE));
+            if (lines == NULL) {
+                report(diagnostics, TRACS_ERROR, number, "Memory allocation failed");
+                free_program(program);
+                return false;
+            }
+            program->lines = lines;
+            program->line_capacity = line_capacity;
         }
-    }
-
-    // Close the file
-    fclose(fp);
+        LINE *line = &program->lines[program->line_count++];
+        line->number = number;
 
-    // Format Correction
-    for (int i = 0; i < *line_count; i++)
-    {
-        if (lines[i].label[0] != '\0' && (
-                strcmp(lines[i].label, "WM") == 0 || strcmp(lines[i].label, "RM") == 0 ||
-                strcmp(lines[i].label, "WACC") == 0 || strcmp(lines[i].label, "WIB") == 0 ||
-                strcmp(lines[i].label, "WIO") == 0 || strcmp(lines[i].label, "RACC") == 0 ||
-                strcmp(lines[i].label, "ADD") == 0 || strcmp(lines[i].label, "SUB") == 0 ||
-                strcmp(lines[i].label, "MUL") == 0 || strcmp(lines[i].label, "AND") == 0 ||
-                strcmp(lines[i].label, "OR") == 0 || strcmp(lines[i].label, "NOT") == 0 ||
-                strcmp(lines[i].label, "XOR") == 0 || strcmp(lines[i].label, "SHL") == 0 ||
-                strcmp(lines[i].label, "SHR") == 0 || strcmp(lines[i].label, "BR") == 0 ||
-                strcmp(lines[i].label, "BRE") == 0 || strcmp(lines[i].label, "BRNE") == 0 ||
-                strcmp(lines[i].label, "BRGT") == 0 || strcmp(lines[i].label, "BRLT") == 0 ||
-                strcmp(lines[i].label, "EOP") == 0 || strcmp(lines[i].label, "SWAP") == 0 ||
-                strcmp(lines[i].label, "WB") == 0
-            ))
-        {
-            // This means it's not a label, so move everything to the right
-            strcpy(lines[i].operand, lines[i].operation);
-            strcpy(lines[i].operation, lines[i].label);
-            strcpy(lines[i].label, "");
+        // Format Correction: a leading mnemonic means there is no label, so move everything to the right
+        if (mnemonic_lookup(text + fields[0].offset, fields[0].length) != NULL) {
+            line->label.offset = fields[0].offset;
+            line->label.length = 0;
+            line->operation = fields[0];
+            line->operand = fields[1];
         }
-    }
-    
-    // Remove lines with empty label, operation, and operand fields
-    int index = 0;
-    for (int i = 0; i < *line_count; i++)
-    {
-        if (lines[i].label[0] != '\0' || lines[i].operation[0] != '\0' || lines[i].operand[0] != '\0')
-        {
-            if (i != index)
-            {
-                strcpy(lines[index].label, lines[i].label);
-                strcpy(lines[index].operation, lines[i].operation);
-                strcpy(lines[index].operand, lines[i].operand);
-            }
-            index++;
+        else {
+            line->label = fields[0];
+            line->operation = fields[1];
+            line->operand = fields[2];
         }
     }
-    *line_count = index;
 
-    return lines;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   free_program
+*   DESCRIPTION :   This function will release the source text and lines of a program.
+*   ARGUMENTS   :   PROGRAM *program
+*   RETURNS     :   VOID
+ *==============================================*/
+void free_program(PROGRAM *program)
+{
+    const TRACS_ALLOCATOR *allocator = program->allocator;
+    source_close(&program->source);
+    if (program->lines != NULL)
+        RELEASE(allocator, program->lines);
+    memset(program, 0, sizeof(*program));
+    program->allocator = allocator;
 }
 
 /*===============================================
@@ -353,43 +547,27 @@ LINE* process_file(const char *filename, int *line_count) {
 OPOBJ get_opcode(char *instruction) 
 { 
     OPOBJ op;
-    if (strcmp(instruction, "WB") == 0)             {op.opcode = 0x30; op.addBoolean = false;}
-    else if (strcmp(instruction, "WM") == 0)        {op.opcode = 0x08; op.addBoolean = true;}
-    else if (strcmp(instruction, "RM") == 0)        {op.opcode = 0x10; op.addBoolean = true;}
-    else if (strcmp(instruction, "WACC") == 0)      {op.opcode = 0x48; op.addBoolean = false;}
-    else if (strcmp(instruction, "WIB") == 0)       {op.opcode = 0x38; op.addBoolean = false;}
-    else if (strcmp(instruction, "WIO") == 0)       {op.opcode = 0x28; op.addBoolean = true;}
-    else if (strcmp(instruction, "RACC") == 0)      {op.opcode = 0x58; op.addBoolean = false;}
-    else if (strcmp(instruction, "ADD") == 0)       {op.opcode = 0xF0; op.addBoolean = false;}
-    else if (strcmp(instruction, "SUB") == 0)       {op.opcode = 0xE8; op.addBoolean = false;}
-    else if (strcmp(instruction, "MUL") == 0)       {op.opcode = 0xD8; op.addBoolean = false;}
-    else if (strcmp(instruction, "AND") == 0)       {op.opcode = 0xD0; op.addBoolean = false;}
-    else if (strcmp(instruction, "OR") == 0)        {op.opcode = 0xC8; op.addBoolean = false;}
-    else if (strcmp(instruction, "NOT") == 0)       {op.opcode = 0xC0; op.addBoolean = false;}
-    else if (strcmp(instruction, "XOR") == 0)       {op.opcode = 0xB8; op.addBoolean = false;}
-    else if (strcmp(instruction, "SHL") == 0)       {op.opcode = 0xB0; op.addBoolean = false;}
-    else if (strcmp(instruction, "SHR") == 0)       {op.opcode = 0xA8; op.addBoolean = false;}
-    else if (strcmp(instruction, "BR") == 0)        {op.opcode = 0x18; op.addBoolean = true;}
-    else if (strcmp(instruction, "BRE") == 0)       {op.opcode = 0xA0; op.addBoolean = true;}
-    else if (strcmp(instruction, "BRNE") == 0)      {op.opcode = 0x98; op.addBoolean = true;}
-    else if (strcmp(instruction, "BRGT") == 0)      {op.opcode = 0x90; op.addBoolean = true;}
-    else if (strcmp(instruction, "BRLT") == 0)      {op.opcode = 0x88; op.addBoolean = true;}
-    else if (strcmp(instruction, "EOP") == 0)       {op.opcode = 0xF8; op.addBoolean = false;}
-    else if (strcmp(instruction, "SWAP") == 0)      {op.opcode = 0x70; op.addBoolean = false;}
-    else op.opcode = -1; // Indicates invalid opcode
+    const MNEMONIC *entry = mnemonic_lookup(instruction, strlen(instruction));
+    if (entry == NULL) {op.opcode = -1; op.addBoolean = false; op.isBranch = false;} // Indicates invalid opcode
+    else {
+        op.opcode = entry->opcode;
+        op.addBoolean = entry->kind == OPERAND_ADDRESS || entry->kind == OPERAND_LABEL;
+        op.isBranch = entry->isBranch;
+    }
     
     return op;
 }
 /*===============================================
 *   FUNCTION    :   printLabels
 *   DESCRIPTION :   This function will print the labels and their addresses.
-*   ARGUMENTS   :   int label_count, LABEL labels
+*   ARGUMENTS   :   const SYMTAB *symbols, FILE *file
 *   RETURNS     :   VOID
  *==============================================*/
-void printLabels(int label_count, LABEL *labels)
+void printLabels(const SYMTAB *symbols, FILE *file)
 {
-    for (int i = 0; i < label_count; i++)
+    for (int i = 0; i < symbols->count; i++)
     {
-        printf("Label: %s, Address: %x\n", labels[i].label, labels[i].address);
+        if (symbols->symbols[i].defined)
+            fprintf(file, "Label: %s, Address: %x\n", symtab_name(symbols, i), symbols->symbols[i].address);
     }
-}
+}
\ No newline at end of file
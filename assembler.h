@@ -1,34 +1,74 @@
 #ifndef ASSEMBLER_H
 #define ASSEMBLER_H
+#include "symtab.h"
+#include "opcodes.h"
+#include "source.h"
+#include "translation.h"
+#include "diagnostics.h"
+#include "stats.h"
 /*===============================================
  *   STRUCTS & DEFINITIONS
  *==============================================*/
-#define MAX_LINE_LENGTH 1000
-#define MAX_LINES 1000
+typedef struct token {
+    unsigned int offset;    // Offset of the token in the source text
+    unsigned int length;    // 0 if the field is absent
+} TOKEN;
 
 typedef struct line {
-    char label[MAX_LINE_LENGTH];
-    char operation[MAX_LINE_LENGTH];
-    char operand[MAX_LINE_LENGTH];
+    TOKEN label;
+    TOKEN operation;
+    TOKEN operand;
+    unsigned int number;    // 1-based line number in the source file
 } LINE;
 
-typedef struct label {
-    char label[MAX_LINE_LENGTH];
-    unsigned int address;
-} LABEL;
+typedef struct program {
+    SOURCE source;          // Entire source text, tokens point into it
+    LINE *lines;            // Non-empty lines, grows with the input
+    int line_count;
+    int line_capacity;
+    const TRACS_ALLOCATOR *allocator;
+} PROGRAM;
 
 typedef struct opcodeObj {
     int opcode;
     bool addBoolean;  
+    bool isBranch;
 } OPOBJ;
 
+typedef struct fixup {
+    int line;       // Line whose operand names the label
+    int word;       // Index of the instruction to patch
+    int symbol;     // Symbol table index of the label
+    bool isBranch;
+    int next;       // Next pending fixup on the same symbol, -1 if none
+} FIXUP;
+
+// Token text is not NUL-terminated; print it with "%.*s" and TOKEN_ARGS
+#define token_text(program, token)  ((program)->source.text + (token).offset)
+#define TOKEN_ARGS(program, token)  (int)(token).length, token_text(program, token)
+
+// Largest literal token_number() reads; every operand and ORG address is smaller
+#define TOKEN_NUMBER_MAX            0xFFFF
+
 /*===============================================
  *   FUNCTION PROTOTYPES
  *==============================================*/
-LINE* process_file(const char *filename, int *line_count);
+bool process_file(const char *filename, const TRACS_ALLOCATOR *allocator, PROGRAM *program, DIAGNOSTICS *diagnostics, STATS *stats);
+bool process_buffer(const char *text, size_t size, const TRACS_ALLOCATOR *allocator, PROGRAM *program, DIAGNOSTICS *diagnostics);
+bool tokenize_program(PROGRAM *program, DIAGNOSTICS *diagnostics);
+void free_program(PROGRAM *program);
+bool token_equals(const PROGRAM *program, TOKEN token, const char *text);
+bool token_is_number(const PROGRAM *program, TOKEN token);
+bool token_number(const PROGRAM *program, TOKEN token, unsigned long *value);
+unsigned int token_column(const PROGRAM *program, TOKEN token);
 OPOBJ get_opcode(char *instruction);
-void set_address(unsigned int *address, int line_count, LINE *lines);
-void printLabels(int label_count, LABEL *labels);
-int assemble();
+void set_address(unsigned int *address, const PROGRAM *program);
+void printLabels(const SYMTAB *symbols, FILE *file);
+unsigned long operand_limit(const MNEMONIC *op);
+unsigned int encode_instruction(const MNEMONIC *op, unsigned long operand);
+void encode_target(MACHINE_CODE *code, int word, unsigned int address);
+bool resolve_fixup(const PROGRAM *program, const FIXUP *fixup, MACHINE_CODE *code, unsigned int address, DIAGNOSTICS *diagnostics);
+bool assemble_program(const PROGRAM *program, MACHINE_CODE *code, DIAGNOSTICS *diagnostics);
+int assemble(const char *filename, MACHINE_CODE *code, const TRACS_ALLOCATOR *allocator, int optimize, STATS *stats);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,469 @@
+/*======================================================================================================
+* FILE        : batch.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the batch simulator, which runs one program on BATCH_LANES machines at
+*               once, each with its own memory and registers. With AVX2 every lane is a byte of a 256-bit
+*               register and an instruction is executed for all lanes that are at the same PC and hold the
+*               same instruction bytes there, under a mask; the others keep their state.
+*
+*               When a conditional branch splits the lanes, the group with the lowest PC runs first, so
+*               lanes that take different paths through a loop meet again at the join. Each lane counts
+*               its own steps, so the results are the same as running each lane through sim_run().
+*               Without AVX2 the lanes are run one after another.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Written rows are tracked so batch_restore() can reset the lanes cheaply.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "opcodes.h"
+#include "batch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_AVX2 1
+#include <immintrin.h>
+#else
+#define BATCH_AVX2 0
+#endif
+
+/*===============================================
+*   FUNCTION    :   batch_init
+*   DESCRIPTION :   This function will clear every lane and mark the first lanes as running.
+*   ARGUMENTS   :   BATCH *batch, unsigned int lanes
+*   RETURNS     :   VOID
+ *==============================================*/
+void batch_init(BATCH *batch, unsigned int lanes)
+{
+    memset(batch, 0, sizeof(*batch));
+    batch->lanes = lanes < BATCH_LANES ? lanes : BATCH_LANES;
+    for (unsigned int lane = 0; lane < BATCH_LANES; lane++)
+        batch->status[lane] = SIM_RUNNING;
+}
+
+/*===============================================
+*   FUNCTION    :   batch_load
+*   DESCRIPTION :   This function will load the same machine code into every lane, like sim_load().
+*   ARGUMENTS   :   BATCH *batch, const MACHINE_CODE *code, unsigned int lanes
+*   RETURNS     :   bool (false if the code does not fit in memory)
+ *==============================================*/
+bool batch_load(BATCH *batch, const MACHINE_CODE *code, unsigned int lanes)
+{
+    unsigned char image[TRACS_MEMORY_SIZE];
+    batch_init(batch, lanes);
+    if (!buildMemoryImage(code, image, NULL))
+        return false;
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++)
+        memset(batch->memory[address], image[address], BATCH_LANES);
+    unsigned short pc = code->count > 0 ? code->bytes[0].address : 0;
+    for (unsigned int lane = 0; lane < BATCH_LANES; lane++)
+        batch->pc[lane] = pc;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   batch_restore
+*   DESCRIPTION :   This function will put every lane back to the state batch_load() left it in, given the same
+*                   memory image, copying only the rows that were written since.
+*   ARGUMENTS   :   BATCH *batch, const unsigned char *image, unsigned short pc, unsigned int lanes
+*   RETURNS     :   VOID
+ *==============================================*/
+void batch_restore(BATCH *batch, const unsigned char *image, unsigned short pc, unsigned int lanes)
+{
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+        if (batch->dirty[address]) {
+            memset(batch->memory[address], image[address], BATCH_LANES);
+            batch->dirty[address] = 0;
+        }
+        if (batch->dirtyIo[address]) {
+            memset(batch->io[address], 0, BATCH_LANES);
+            batch->dirtyIo[address] = 0;
+        }
+    }
+    memset(batch->mbr, 0, sizeof(batch->mbr));
+    memset(batch->acc, 0, sizeof(batch->acc));
+    memset(batch->iob, 0, sizeof(batch->iob));
+    memset(batch->flags, 0, sizeof(batch->flags));
+    memset(batch->steps, 0, sizeof(batch->steps));
+    for (unsigned int lane = 0; lane < BATCH_LANES; lane++) {
+        batch->pc[lane] = pc;
+        batch->status[lane] = SIM_RUNNING;
+    }
+    batch->lanes = lanes < BATCH_LANES ? lanes : BATCH_LANES;
+}
+
+/*===============================================
+*   FUNCTION    :   batch_set_lane
+*   DESCRIPTION :   This function will copy a machine into one lane.
+*   ARGUMENTS   :   BATCH *batch, unsigned int lane, const MACHINE *machine
+*   RETURNS     :   VOID
+ *==============================================*/
+void batch_set_lane(BATCH *batch, unsigned int lane, const MACHINE *machine)
+{
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+        batch->memory[address][lane] = machine->memory[address];
+        batch->io[address][lane] = machine->io[address];
+    }
+    batch->mbr[lane] = machine->mbr;
+    batch->acc[lane] = machine->acc;
+    batch->iob[lane] = machine->iob;
+    batch->flags[lane] = machine->flags;
+    batch->pc[lane] = (unsigned short)machine->pc;
+    batch->steps[lane] = machine->steps;
+    batch->status[lane] = machine->status;
+    memset(batch->dirty, 1, sizeof(batch->dirty));
+    memset(batch->dirtyIo, 1, sizeof(batch->dirtyIo));
+}
+
+/*===============================================
+*   FUNCTION    :   batch_get_lane
+*   DESCRIPTION :   This function will copy one lane out into a machine.
+*   ARGUMENTS   :   const BATCH *batch, unsigned int lane, MACHINE *machine
+*   RETURNS     :   VOID
+ *==============================================*/
+void batch_get_lane(const BATCH *batch, unsigned int lane, MACHINE *machine)
+{
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+        machine->memory[address] = batch->memory[address][lane];
+        machine->io[address] = batch->io[address][lane];
+    }
+    machine->mbr = batch->mbr[lane];
+    machine->acc = batch->acc[lane];
+    machine->iob = batch->iob[lane];
+    machine->flags = batch->flags[lane];
+    machine->pc = batch->pc[lane];
+    machine->steps = batch->steps[lane];
+    machine->status = batch->status[lane];
+}
+
+/*===============================================
+*   FUNCTION    :   run_lanes
+*   DESCRIPTION :   This function will run every lane on its own through sim_run().
+*   ARGUMENTS   :   BATCH *batch, unsigned long long step_limit
+*   RETURNS     :   VOID
+ *==============================================*/
+static void run_lanes(BATCH *batch, unsigned long long step_limit)
+{
+    MACHINE *machine = malloc(sizeof(MACHINE));
+    if (machine == NULL)
+        return;
+    for (unsigned int lane = 0; lane < batch->lanes; lane++) {
+        if (batch->status[lane] != SIM_RUNNING)
+            continue;
+        batch_get_lane(batch, lane, machine);
+        sim_run(machine, step_limit);
+        batch_set_lane(batch, lane, machine);
+    }
+    free(machine);
+}
+
+#if BATCH_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+#define LOAD(row)           _mm256_loadu_si256((const __m256i *)(row))
+#define STORE(row, value)   _mm256_storeu_si256((__m256i *)(row), (value))
+#define BLEND(old, new, mask) _mm256_blendv_epi8((old), (new), (mask))
+#define DEAD_PC 0xFFFF      // Stopped lanes never have the lowest PC
+
+/*===============================================
+*   FUNCTION    :   alu_flags
+*   DESCRIPTION :   This function will build the flags of every lane from an 8-bit result and the CARRY and
+*                   OVERFLOW masks.
+*   ARGUMENTS   :   __m256i result, __m256i carry, __m256i overflow
+*   RETURNS     :   __m256i
+ *==============================================*/
+static inline AVX2 __m256i alu_flags(__m256i result, __m256i carry, __m256i overflow)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i flags = _mm256_and_si256(_mm256_cmpeq_epi8(result, zero), _mm256_set1_epi8(FLAG_ZERO));
+    flags = _mm256_or_si256(flags, _mm256_and_si256(carry, _mm256_set1_epi8(FLAG_CARRY)));
+    flags = _mm256_or_si256(flags, _mm256_and_si256(_mm256_cmpgt_epi8(zero, result), _mm256_set1_epi8(FLAG_SIGN)));
+    return _mm256_or_si256(flags, _mm256_and_si256(overflow, _mm256_set1_epi8(FLAG_OVERFLOW)));
+}
+
+/*===============================================
+*   FUNCTION    :   stop_lanes
+*   DESCRIPTION :   This function will stop the given lanes with a status and PC, and move their PC out of the way.
+*   ARGUMENTS   :   BATCH *batch, unsigned int *live, unsigned int lanes, SIM_STATUS status, unsigned short pc,
+*                   unsigned short *pcs, const unsigned long long *executed
+*   RETURNS     :   VOID
+ *==============================================*/
+static void stop_lanes(BATCH *batch, unsigned int *live, unsigned int lanes, SIM_STATUS status, unsigned short pc,
+                       unsigned short *pcs, const unsigned long long *executed)
+{
+    for (unsigned int bits = lanes; bits != 0; bits &= bits - 1) {
+        unsigned int lane = (unsigned int)__builtin_ctz(bits);
+        batch->status[lane] = status;
+        batch->pc[lane] = pc;
+        batch->steps[lane] += executed[lane];
+        pcs[lane] = DEAD_PC;
+    }
+    *live &= ~lanes;
+}
+
+/*===============================================
+*   FUNCTION    :   run_vectors
+*   DESCRIPTION :   This function will run all lanes in lockstep with AVX2.
+*   ARGUMENTS   :   BATCH *batch, unsigned long long step_limit
+*   RETURNS     :   VOID
+ *==============================================*/
+static AVX2 void run_vectors(BATCH *batch, unsigned long long step_limit)
+{
+    unsigned short pcs[BATCH_LANES];
+    unsigned long long budget[BATCH_LANES];
+    unsigned long long executed[BATCH_LANES];
+    unsigned int live = 0;
+
+    for (unsigned int lane = 0; lane < BATCH_LANES; lane++) {
+        executed[lane] = 0;
+        budget[lane] = step_limit == 0 ? ULLONG_MAX :
+                       step_limit > batch->steps[lane] ? step_limit - batch->steps[lane] : 1;
+        pcs[lane] = DEAD_PC;
+        if (lane >= batch->lanes || batch->status[lane] != SIM_RUNNING)
+            continue;
+        if (batch->pc[lane] + 1 >= TRACS_MEMORY_SIZE) {
+            batch->status[lane] = SIM_PC_OUT_OF_RANGE;
+            continue;
+        }
+        pcs[lane] = batch->pc[lane];
+        live |= 1u << lane;
+    }
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_cmpeq_epi8(zero, zero);
+    __m256i acc = LOAD(batch->acc);
+    __m256i mbr = LOAD(batch->mbr);
+    __m256i iob = LOAD(batch->iob);
+    __m256i flags = LOAD(batch->flags);
+    __m256i pcLow = LOAD(pcs);
+    __m256i pcHigh = LOAD(pcs + 16);
+
+    // Steps are counted per lane only when the lanes are split; in lockstep one counter does for all
+    unsigned long long ticks = 0;
+    unsigned long long waited[BATCH_LANES] = { 0 };
+    unsigned long long nextCheck = ULLONG_MAX;
+    for (unsigned int bits = live; bits != 0; bits &= bits - 1) {
+        unsigned int lane = (unsigned int)__builtin_ctz(bits);
+        if (budget[lane] < nextCheck)
+            nextCheck = budget[lane];
+    }
+
+    while (live != 0) {
+        // The lanes at the lowest PC go next
+        __m256i lowest = _mm256_min_epu16(pcLow, pcHigh);
+        __m128i lowest8 = _mm_min_epu16(_mm256_castsi256_si128(lowest), _mm256_extracti128_si256(lowest, 1));
+        unsigned int pc = (unsigned int)_mm_cvtsi128_si32(_mm_minpos_epu16(lowest8)) & 0xFFFF;
+        __m256i target = _mm256_set1_epi16((short)pc);
+        __m256i mask = _mm256_permute4x64_epi64(_mm256_packs_epi16(_mm256_cmpeq_epi16(pcLow, target),
+                                                                   _mm256_cmpeq_epi16(pcHigh, target)), 0xD8);
+        unsigned int group = (unsigned int)_mm256_movemask_epi8(mask);
+
+        if (pc + 1 >= TRACS_MEMORY_SIZE) {
+            for (unsigned int bits = group; bits != 0; bits &= bits - 1)
+                executed[__builtin_ctz(bits)] = ticks - waited[__builtin_ctz(bits)];
+            STORE(pcs, pcLow);
+            STORE(pcs + 16, pcHigh);
+            stop_lanes(batch, &live, group, SIM_PC_OUT_OF_RANGE, (unsigned short)pc, pcs, executed);
+            pcLow = LOAD(pcs);
+            pcHigh = LOAD(pcs + 16);
+            continue;
+        }
+
+        // Lanes that rewrote the instruction here wait for a group of their own
+        unsigned int first = (unsigned int)__builtin_ctz(group);
+        unsigned char high = batch->memory[pc][first];
+        unsigned char low = batch->memory[pc + 1][first];
+        mask = _mm256_and_si256(mask, _mm256_and_si256(_mm256_cmpeq_epi8(LOAD(batch->memory[pc]), _mm256_set1_epi8((char)high)),
+                                                       _mm256_cmpeq_epi8(LOAD(batch->memory[pc + 1]), _mm256_set1_epi8((char)low))));
+        group = (unsigned int)_mm256_movemask_epi8(mask);
+        unsigned int operand = ((high & 0x07) << 8) | low;
+        __m256i immediate = _mm256_set1_epi8((char)(operand & 0xFF));
+        __m256i taken = zero;
+        __m256i result, carry, overflow;
+        bool branch = false;
+        bool halt = false;
+
+        switch (high & OPCODE_MASK) {
+        case OP_WB:   mbr = BLEND(mbr, immediate, mask); break;
+        case OP_WM:
+            STORE(batch->memory[operand], BLEND(LOAD(batch->memory[operand]), mbr, mask));
+            batch->dirty[operand] = 1;
+            break;
+        case OP_RM:   mbr = BLEND(mbr, LOAD(batch->memory[operand]), mask); break;
+        case OP_WACC: acc = BLEND(acc, mbr, mask); break;
+        case OP_WIB:  iob = BLEND(iob, immediate, mask); break;
+        case OP_WIO:
+            STORE(batch->io[operand], BLEND(LOAD(batch->io[operand]), iob, mask));
+            batch->dirtyIo[operand] = 1;
+            break;
+        case OP_RACC: mbr = BLEND(mbr, acc, mask); break;
+        case OP_SWAP: {
+            __m256i swapped = mbr;
+            mbr = BLEND(mbr, iob, mask);
+            iob = BLEND(iob, swapped, mask);
+            break;
+        }
+        case OP_ADD:
+            result = _mm256_add_epi8(acc, mbr);
+            carry = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_adds_epu8(acc, mbr), result), ones);
+            overflow = _mm256_cmpgt_epi8(zero, _mm256_andnot_si256(_mm256_xor_si256(acc, mbr), _mm256_xor_si256(acc, result)));
+            flags = BLEND(flags, alu_flags(result, carry, overflow), mask);
+            acc = BLEND(acc, result, mask);
+            break;
+        case OP_SUB:
+            result = _mm256_sub_epi8(acc, mbr);
+            carry = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(acc, mbr), acc), ones);
+            overflow = _mm256_cmpgt_epi8(zero, _mm256_and_si256(_mm256_xor_si256(acc, mbr), _mm256_xor_si256(acc, result)));
+            flags = BLEND(flags, alu_flags(result, carry, overflow), mask);
+            acc = BLEND(acc, result, mask);
+            break;
+        case OP_MUL: {
+            __m256i low16 = _mm256_mullo_epi16(_mm256_unpacklo_epi8(acc, zero), _mm256_unpacklo_epi8(mbr, zero));
+            __m256i high16 = _mm256_mullo_epi16(_mm256_unpackhi_epi8(acc, zero), _mm256_unpackhi_epi8(mbr, zero));
+            __m256i byte = _mm256_set1_epi16(0xFF);
+            result = _mm256_packus_epi16(_mm256_and_si256(low16, byte), _mm256_and_si256(high16, byte));
+            carry = _mm256_packus_epi16(_mm256_srli_epi16(low16, 8), _mm256_srli_epi16(high16, 8));
+            carry = _mm256_xor_si256(_mm256_cmpeq_epi8(carry, zero), ones);
+            flags = BLEND(flags, alu_flags(result, carry, zero), mask);
+            acc = BLEND(acc, result, mask);
+            break;
+        }
+        case OP_AND: result = _mm256_and_si256(acc, mbr); goto logic;
+        case OP_OR:  result = _mm256_or_si256(acc, mbr); goto logic;
+        case OP_XOR: result = _mm256_xor_si256(acc, mbr); goto logic;
+        case OP_NOT: result = _mm256_xor_si256(acc, ones); goto logic;
+        logic:
+            flags = BLEND(flags, alu_flags(result, zero, zero), mask);
+            acc = BLEND(acc, result, mask);
+            break;
+        case OP_SHL:
+            result = _mm256_add_epi8(acc, acc);
+            flags = BLEND(flags, alu_flags(result, _mm256_cmpgt_epi8(zero, acc), zero), mask);
+            acc = BLEND(acc, result, mask);
+            break;
+        case OP_SHR:
+            result = _mm256_and_si256(_mm256_srli_epi16(acc, 1), _mm256_set1_epi8(0x7F));
+            carry = _mm256_cmpeq_epi8(_mm256_and_si256(acc, _mm256_set1_epi8(1)), _mm256_set1_epi8(1));
+            flags = BLEND(flags, alu_flags(result, carry, zero), mask);
+            acc = BLEND(acc, result, mask);
+            break;
+        case OP_BR:
+            taken = mask;
+            branch = true;
+            break;
+        case OP_BRE: case OP_BRNE: case OP_BRGT: case OP_BRLT: {
+            result = _mm256_sub_epi8(acc, mbr);
+            __m256i equal = _mm256_cmpeq_epi8(acc, mbr);
+            __m256i below = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(acc, mbr), acc), ones);
+            overflow = _mm256_cmpgt_epi8(zero, _mm256_and_si256(_mm256_xor_si256(acc, mbr), _mm256_xor_si256(acc, result)));
+            flags = BLEND(flags, alu_flags(result, below, overflow), mask);
+            switch (high & OPCODE_MASK) {
+            case OP_BRE:  taken = equal; break;
+            case OP_BRNE: taken = _mm256_xor_si256(equal, ones); break;
+            case OP_BRGT: taken = _mm256_xor_si256(_mm256_or_si256(equal, below), ones); break;
+            default:      taken = below; break;
+            }
+            taken = _mm256_and_si256(taken, mask);
+            branch = true;
+            break;
+        }
+        case OP_EOP:
+            halt = true;
+            break;
+        default:
+            for (unsigned int bits = group; bits != 0; bits &= bits - 1)
+                executed[__builtin_ctz(bits)] = ticks - waited[__builtin_ctz(bits)];
+            STORE(pcs, pcLow);
+            STORE(pcs + 16, pcHigh);
+            stop_lanes(batch, &live, group, SIM_INVALID_OPCODE, (unsigned short)pc, pcs, executed);
+            pcLow = LOAD(pcs);
+            pcHigh = LOAD(pcs + 16);
+            continue;
+        }
+
+        // One step for the group; the other live lanes waited
+        ticks++;
+        for (unsigned int bits = live & ~group; bits != 0; bits &= bits - 1)
+            waited[__builtin_ctz(bits)]++;
+
+        __m256i groupLow = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(mask));
+        __m256i groupHigh = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(mask, 1));
+        __m256i two = _mm256_set1_epi16(2);
+        pcLow = _mm256_add_epi16(pcLow, _mm256_and_si256(groupLow, two));
+        pcHigh = _mm256_add_epi16(pcHigh, _mm256_and_si256(groupHigh, two));
+        if (branch) {
+            __m256i destination = _mm256_set1_epi16((short)operand);
+            pcLow = BLEND(pcLow, destination, _mm256_cvtepi8_epi16(_mm256_castsi256_si128(taken)));
+            pcHigh = BLEND(pcHigh, destination, _mm256_cvtepi8_epi16(_mm256_extracti128_si256(taken, 1)));
+        }
+
+        if (halt || ticks >= nextCheck) {
+            STORE(pcs, pcLow);
+            STORE(pcs + 16, pcHigh);
+            for (unsigned int lane = 0; lane < BATCH_LANES; lane++)
+                if (live & (1u << lane))
+                    executed[lane] = ticks - waited[lane];
+            if (halt)
+                stop_lanes(batch, &live, group, SIM_HALTED, (unsigned short)(pc + 2), pcs, executed);
+
+            // Lanes that used up their steps stop where they are
+            nextCheck = ULLONG_MAX;
+            for (unsigned int bits = live; bits != 0; bits &= bits - 1) {
+                unsigned int lane = (unsigned int)__builtin_ctz(bits);
+                if (executed[lane] >= budget[lane])
+                    stop_lanes(batch, &live, 1u << lane, SIM_STEP_LIMIT, pcs[lane], pcs, executed);
+                else if (ticks + budget[lane] - executed[lane] < nextCheck)
+                    nextCheck = ticks + budget[lane] - executed[lane];
+            }
+            pcLow = LOAD(pcs);
+            pcHigh = LOAD(pcs + 16);
+        }
+    }
+
+    STORE(batch->acc, acc);
+    STORE(batch->mbr, mbr);
+    STORE(batch->iob, iob);
+    STORE(batch->flags, flags);
+}
+
+#endif
+
+/*===============================================
+*   FUNCTION    :   batch_vectorized
+*   DESCRIPTION :   This function will tell if batch_run() can use AVX2 on this host.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   bool
+ *==============================================*/
+bool batch_vectorized(void)
+{
+#if BATCH_AVX2
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+/*===============================================
+*   FUNCTION    :   batch_run
+*   DESCRIPTION :   This function will run every lane until EOP, a fault, or step_limit instructions (0 for no
+*                   limit), exactly like sim_run() on each lane.
+*   ARGUMENTS   :   BATCH *batch, unsigned long long step_limit
+*   RETURNS     :   VOID
+ *==============================================*/
+void batch_run(BATCH *batch, unsigned long long step_limit)
+{
+#if BATCH_AVX2
+    if (batch_vectorized()) {
+        run_vectors(batch, step_limit);
+        return;
+    }
+#endif
+    run_lanes(batch, step_limit);
+}
@@ -0,0 +1,41 @@
+#ifndef BATCH_H
+#define BATCH_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdbool.h>
+#include "simulator.h"
+
+#define BATCH_LANES 32      // One AVX2 register of bytes
+
+/*
+ * BATCH_LANES independent machines stored lane-minor, so one 32-byte row holds a memory location of every
+ * lane and an instruction can be applied to all of them with one vector operation.
+ */
+typedef struct tracs_batch {
+    unsigned char memory[TRACS_MEMORY_SIZE][BATCH_LANES];   // memory[address][lane]
+    unsigned char io[TRACS_MEMORY_SIZE][BATCH_LANES];
+    unsigned char mbr[BATCH_LANES];
+    unsigned char acc[BATCH_LANES];
+    unsigned char iob[BATCH_LANES];
+    unsigned char flags[BATCH_LANES];
+    unsigned short pc[BATCH_LANES];
+    unsigned long long steps[BATCH_LANES];
+    SIM_STATUS status[BATCH_LANES];
+    unsigned int lanes;                                     // Lanes in use, the rest are left alone
+    unsigned char dirty[TRACS_MEMORY_SIZE];                 // Memory rows written since the last load or restore
+    unsigned char dirtyIo[TRACS_MEMORY_SIZE];
+} BATCH;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void batch_init(BATCH *batch, unsigned int lanes);
+bool batch_load(BATCH *batch, const MACHINE_CODE *code, unsigned int lanes);
+void batch_restore(BATCH *batch, const unsigned char *image, unsigned short pc, unsigned int lanes);
+void batch_set_lane(BATCH *batch, unsigned int lane, const MACHINE *machine);
+void batch_get_lane(const BATCH *batch, unsigned int lane, MACHINE *machine);
+void batch_run(BATCH *batch, unsigned long long step_limit);
+bool batch_vectorized(void);
+
+#endif
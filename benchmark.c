@@ -0,0 +1,460 @@
+/*======================================================================================================
+* FILE        : benchmark.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the benchmark harness (the Benchmark target). It generates synthetic
+*               TRACS programs of the given sizes, label density, branch ratio and comment density, then
+*               times process_file(), assemble_program() and interpretTranslation() on each and writes the
+*               throughput and peak memory as JSON, so runs can be compared against a performance budget.
+*               Peak memory is what the arena held for one size, so it is not carried over from the sizes
+*               before it the way the process-wide peak RSS is.
+*
+*               The same seed gives the same programs, so results from different builds are comparable.
+*               Programs bigger than 2 KB of machine code do not fit TRACS memory; the assembler only warns
+*               about that, which is all the benchmark needs.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Assembles out of an arena, like the command-line workers.
+*   16 October, 2026: V1.2 - Peak memory per size is the arena's, instead of the process-wide peak RSS.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "assembler.h"
+#include "translation.h"
+#include "stats.h"
+#include "arena.h"
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define BENCH_DEFAULT_SIZES "1000,10000,100000,1000000"
+#define BENCH_MAX_SIZES     16
+
+typedef struct generator {
+    double label_density;       // Fraction of lines that define a label
+    double branch_ratio;        // Fraction of instructions that branch to a label
+    double comment_density;     // Fraction of lines with a trailing comment
+    unsigned long long seed;
+} GENERATOR;
+
+typedef struct benchOptions {
+    GENERATOR generator;
+    long sizes[BENCH_MAX_SIZES];
+    int size_count;
+    int repeat;                 // Each size is assembled this many times; the fastest run is kept
+    const char *directory;      // Where the generated programs and translations go
+    const char *output;         // JSON results, NULL for stdout
+    bool keep;                  // Leave the generated files behind
+} BENCH_OPTIONS;
+
+typedef struct benchResult {
+    long lines;
+    long labels;
+    size_t source_bytes;
+    double generate_seconds;
+    STATS stats;                // read, tokenize (process_file), encode (assemble_program), output
+    double interpret_seconds;   // interpretTranslation() of the written translation.txt
+    int interpreted_lines;
+    size_t peak_bytes;          // Most the assembler's arena held for this size
+} BENCH_RESULT;
+
+static const char *fillers[] = { "WACC", "RACC", "ADD", "SUB", "MUL", "AND", "OR", "NOT", "XOR", "SHL", "SHR", "SWAP" };
+static const char *branches[] = { "BR", "BRE", "BRNE", "BRGT", "BRLT" };
+
+/*===============================================
+*   FUNCTION    :   next_random
+*   DESCRIPTION :   This function will step a xorshift64 generator.
+*   ARGUMENTS   :   unsigned long long *state
+*   RETURNS     :   unsigned long long
+ *==============================================*/
+static unsigned long long next_random(unsigned long long *state)
+{
+    unsigned long long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*===============================================
+*   FUNCTION    :   chance
+*   DESCRIPTION :   This function will return true with the given probability.
+*   ARGUMENTS   :   unsigned long long *state, double probability
+*   RETURNS     :   bool
+ *==============================================*/
+static bool chance(unsigned long long *state, double probability)
+{
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0) < probability;
+}
+
+/*===============================================
+*   FUNCTION    :   generate_program
+*   DESCRIPTION :   This function will write a program of the given number of lines, ending in EOP. Labels are
+*                   spread evenly over the lines, and every branch names one of them, forward or backward.
+*   ARGUMENTS   :   const char *filename, long lines, const GENERATOR *generator, long *labels, size_t *bytes
+*   RETURNS     :   bool
+ *==============================================*/
+static bool generate_program(const char *filename, long lines, const GENERATOR *generator, long *labels, size_t *bytes)
+{
+    FILE *file = fopen(filename, "w");
+    if (file == NULL)
+        return false;
+
+    unsigned long long state = generator->seed ? generator->seed : 1;
+    long label_count = (long)((lines - 1) * generator->label_density);
+    long next_label = 0;
+    fprintf(file, "ORG 0x000\n");
+    for (long i = 1; i < lines; i++) {
+        // Label k sits on line 1 + k * (lines - 1) / label_count
+        if (next_label < label_count && i - 1 >= next_label * (lines - 1) / label_count)
+            fprintf(file, "L%ld\t", next_label++);
+        else
+            fputc('\t', file);
+
+        unsigned long long r = next_random(&state);
+        if (i == lines - 1)
+            fprintf(file, "EOP");
+        else if (label_count > 0 && chance(&state, generator->branch_ratio))
+            fprintf(file, "%s L%llu", branches[r % 5], (r >> 8) % (unsigned long long)label_count);
+        else {
+            switch (r % 6) {
+            case 0:  fprintf(file, "WB 0x%02llx", (r >> 8) & 0xFF); break;
+            case 1:  fprintf(file, "WM 0x%03llx", 0x400 | ((r >> 8) & 0x3FF)); break;
+            case 2:  fprintf(file, "RM 0x%03llx", 0x400 | ((r >> 8) & 0x3FF)); break;
+            case 3:  fprintf(file, "WIB 0x%02llx", (r >> 8) & 0xFF); break;
+            default: fprintf(file, "%s", fillers[(r >> 8) % (sizeof(fillers) / sizeof(fillers[0]))]); break;
+            }
+        }
+        if (chance(&state, generator->comment_density))
+            fprintf(file, "\t; generated line %ld", i);
+        fputc('\n', file);
+    }
+
+    *labels = label_count;
+    long position = ftell(file);
+    *bytes = position > 0 ? (size_t)position : 0;
+    bool ok = !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_once
+*   DESCRIPTION :   This function will assemble a program the way assemble() does, timing each phase into stats,
+*                   then write its translation.txt and time reading it back with interpretTranslation().
+*                   The assembler's memory comes from arena, which is reset afterwards.
+*   ARGUMENTS   :   const char *source, const char *translation, ARENA *arena, STATS *stats,
+*                   double *interpret_seconds, int *interpreted_lines
+*   RETURNS     :   bool
+ *==============================================*/
+static bool assemble_once(const char *source, const char *translation, ARENA *arena, STATS *stats, double *interpret_seconds,
+                          int *interpreted_lines)
+{
+    PROGRAM program;
+    MACHINE_CODE code;
+    DIAGNOSTICS diagnostics;
+    bool ok = false;
+    stats_init(stats);
+    stats->backing = &arena->allocator;
+    diagnostics_init(&diagnostics, &stats->allocator);
+
+    if (process_file(source, &stats->allocator, &program, &diagnostics, stats)) {
+        stats_begin(stats, STATS_ENCODE);
+        ok = assemble_program(&program, &code, &diagnostics);
+        stats_end(stats, program.line_count, ok ? code.count : 0);
+        free_program(&program);
+    }
+    if (diagnostics.errors > 0)
+        print_diagnostics(&diagnostics, source, stderr);
+    diagnostics_free(&diagnostics);
+    if (!ok) {
+        arena_reset(arena);
+        return false;
+    }
+
+    FILE *file = fopen(translation, "w");
+    stats_begin(stats, STATS_OUTPUT);
+    ok = file != NULL && writeTranslation(&code, file);
+    if (file != NULL && fclose(file) != 0)
+        ok = false;
+    stats_end(stats, code.count / 2, code.count);
+    freeMachineCode(&code);
+    arena_reset(arena);
+    if (!ok)
+        return false;
+
+    double started = stats_now();
+    MACHINE_CODE_LINE *lines = interpretTranslation(translation, interpreted_lines);
+    *interpret_seconds = stats_now() - started;
+    free(lines);
+    return lines != NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   total_seconds
+*   DESCRIPTION :   This function will add up the time of every phase.
+*   ARGUMENTS   :   const STATS *stats
+*   RETURNS     :   double
+ *==============================================*/
+static double total_seconds(const STATS *stats)
+{
+    double seconds = 0;
+    for (int phase = 0; phase < STATS_PHASES; phase++)
+        seconds += stats->phases[phase].seconds;
+    return seconds;
+}
+
+/*===============================================
+*   FUNCTION    :   run_size
+*   DESCRIPTION :   This function will generate one program and keep its fastest assembly out of options->repeat.
+*   ARGUMENTS   :   const BENCH_OPTIONS *options, long lines, BENCH_RESULT *result
+*   RETURNS     :   bool
+ *==============================================*/
+static bool run_size(const BENCH_OPTIONS *options, long lines, BENCH_RESULT *result)
+{
+    char source[4096], translation[4096];
+    snprintf(source, sizeof(source), "%s/bench_%ld.asm", options->directory, lines);
+    snprintf(translation, sizeof(translation), "%s/bench_%ld.txt", options->directory, lines);
+
+    memset(result, 0, sizeof(*result));
+    result->lines = lines;
+    double started = stats_now();
+    if (!generate_program(source, lines, &options->generator, &result->labels, &result->source_bytes)) {
+        fprintf(stderr, "Error writing %s\n", source);
+        return false;
+    }
+    result->generate_seconds = stats_now() - started;
+
+    bool ok = true;
+    ARENA arena;
+    arena_init(&arena);
+    for (int run = 0; ok && run < options->repeat; run++) {
+        STATS *stats = malloc(sizeof(STATS));
+        double interpret_seconds = 0;
+        int interpreted_lines = 0;
+        ok = stats != NULL && assemble_once(source, translation, &arena, stats, &interpret_seconds, &interpreted_lines);
+        if (ok && (run == 0 || total_seconds(stats) + interpret_seconds < total_seconds(&result->stats) + result->interpret_seconds)) {
+            result->stats = *stats;
+            result->interpret_seconds = interpret_seconds;
+            result->interpreted_lines = interpreted_lines;
+        }
+        free(stats);
+    }
+    // Every run keeps the blocks of the one before, so the arena ends at the largest
+    result->peak_bytes = arena_capacity(&arena);
+    arena_free(&arena);
+
+    if (!options->keep) {
+        remove(source);
+        remove(translation);
+    }
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   rate
+*   DESCRIPTION :   This function will divide a count by a time, 0 when no time was measured.
+*   ARGUMENTS   :   double count, double seconds
+*   RETURNS     :   double
+ *==============================================*/
+static double rate(double count, double seconds)
+{
+    return seconds > 0 ? count / seconds : 0;
+}
+
+/*===============================================
+*   FUNCTION    :   print_result
+*   DESCRIPTION :   This function will print one size as a row of the human-readable table.
+*   ARGUMENTS   :   const BENCH_RESULT *result, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+static void print_result(const BENCH_RESULT *result, FILE *file)
+{
+    const STATS_RECORD *phases = result->stats.phases;
+    double process = phases[STATS_READ].seconds + phases[STATS_TOKENIZE].seconds;
+    fprintf(file, "%10ld %12zu %16.0f %16.0f %16.0f %10zu\n", result->lines, result->source_bytes,
+            rate(result->lines, process), rate(result->lines, phases[STATS_ENCODE].seconds),
+            rate(result->interpreted_lines, result->interpret_seconds), result->peak_bytes / 1024);
+}
+
+/*===============================================
+*   FUNCTION    :   write_json
+*   DESCRIPTION :   This function will write the configuration and every result as one JSON document.
+*   ARGUMENTS   :   const BENCH_OPTIONS *options, const BENCH_RESULT *results, int count, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+static void write_json(const BENCH_OPTIONS *options, const BENCH_RESULT *results, int count, FILE *file)
+{
+    const GENERATOR *generator = &options->generator;
+    fprintf(file, "{\"benchmark\":\"tracsasm\",\"version\":\"%s\",\"config\":{\"label_density\":%g,\"branch_ratio\":%g,"
+            "\"comment_density\":%g,\"seed\":%llu,\"repeat\":%d},\"results\":[\n", TRACSASM_VERSION,
+            generator->label_density, generator->branch_ratio, generator->comment_density, generator->seed, options->repeat);
+    for (int i = 0; i < count; i++) {
+        const BENCH_RESULT *result = &results[i];
+        const STATS_RECORD *phases = result->stats.phases;
+        double process = phases[STATS_READ].seconds + phases[STATS_TOKENIZE].seconds;
+        fprintf(file, "{\"lines\":%ld,\"labels\":%ld,\"source_bytes\":%zu,\"generate_seconds\":%.6f,"
+                "\"process_file\":{\"seconds\":%.9f,\"lines_per_second\":%.1f,\"bytes_per_second\":%.1f},"
+                "\"assemble_program\":{\"seconds\":%.9f,\"lines_per_second\":%.1f},"
+                "\"interpretTranslation\":{\"seconds\":%.9f,\"lines\":%d,\"lines_per_second\":%.1f},"
+                "\"peak_bytes\":%zu,\"phases\":",
+                result->lines, result->labels, result->source_bytes, result->generate_seconds,
+                process, rate(result->lines, process), rate(result->source_bytes, process),
+                phases[STATS_ENCODE].seconds, rate(result->lines, phases[STATS_ENCODE].seconds),
+                result->interpret_seconds, result->interpreted_lines, rate(result->interpreted_lines, result->interpret_seconds),
+                result->peak_bytes);
+        stats_print_json(&result->stats, "generated", file);
+        fprintf(file, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "]}\n");
+}
+
+/*===============================================
+*   FUNCTION    :   parse_sizes
+*   DESCRIPTION :   This function will read a comma-separated list of line counts.
+*   ARGUMENTS   :   const char *text, BENCH_OPTIONS *options
+*   RETURNS     :   bool
+ *==============================================*/
+static bool parse_sizes(const char *text, BENCH_OPTIONS *options)
+{
+    options->size_count = 0;
+    while (*text != '\0') {
+        char *end;
+        long size = strtol(text, &end, 10);
+        if (end == text || size < 2 || options->size_count == BENCH_MAX_SIZES)
+            return false;
+        options->sizes[options->size_count++] = size;
+        if (*end == ',')
+            end++;
+        else if (*end != '\0')
+            return false;
+        text = end;
+    }
+    return options->size_count > 0;
+}
+
+/*===============================================
+*   FUNCTION    :   parse_fraction
+*   DESCRIPTION :   This function will read a number between 0 and 1.
+*   ARGUMENTS   :   const char *text, double *value
+*   RETURNS     :   bool
+ *==============================================*/
+static bool parse_fraction(const char *text, double *value)
+{
+    char *end;
+    *value = strtod(text, &end);
+    return end != text && *end == '\0' && *value >= 0 && *value <= 1;
+}
+
+/*===============================================
+*   FUNCTION    :   usage
+*   DESCRIPTION :   This function will print the command-line help.
+*   ARGUMENTS   :   FILE *file, const char *program
+*   RETURNS     :   VOID
+ *==============================================*/
+static void usage(FILE *file, const char *program)
+{
+    fprintf(file,
+        "Usage: %s [options]\n"
+        "Generates TRACS programs and measures process_file(), assemble_program() and interpretTranslation().\n"
+        "  -n SIZES    comma-separated line counts (default: " BENCH_DEFAULT_SIZES ")\n"
+        "  -l RATIO    fraction of lines with a label (default: 0.1)\n"
+        "  -b RATIO    fraction of instructions that are branches (default: 0.1)\n"
+        "  -c RATIO    fraction of lines with a comment (default: 0.3)\n"
+        "  -x SEED     generator seed (default: 1)\n"
+        "  -r COUNT    assemble each size COUNT times and keep the fastest (default: 3)\n"
+        "  -d DIR      directory for the generated files (default: .)\n"
+        "  -o FILE     write the JSON results to FILE instead of stdout\n"
+        "  -k          keep the generated files\n"
+        "  -h          show this help\n", program);
+}
+
+/*===============================================
+*   FUNCTION    :   main
+*   DESCRIPTION :   This function will run the benchmark for every size and write the results.
+*   ARGUMENTS   :   int argc, char *argv[]
+*   RETURNS     :   int (0 if every size assembled)
+ *==============================================*/
+int main(int argc, char *argv[])
+{
+    BENCH_OPTIONS options = { { 0.1, 0.1, 0.3, 1 }, { 0 }, 0, 3, ".", NULL, false };
+    parse_sizes(BENCH_DEFAULT_SIZES, &options);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0)
+        {
+            usage(stdout, argv[0]);
+            return 0;
+        }
+        if (strcmp(arg, "-k") == 0)
+        {
+            options.keep = true;
+            continue;
+        }
+        if (arg[0] != '-' || strchr("nlbcxrdo", arg[1]) == NULL || arg[1] == '\0' || arg[2] != '\0' || i + 1 == argc)
+        {
+            usage(stderr, argv[0]);
+            return 2;
+        }
+        const char *value = argv[++i];
+        char *end;
+        bool valid = true;
+        switch (arg[1])
+        {
+        case 'n': valid = parse_sizes(value, &options); break;
+        case 'l': valid = parse_fraction(value, &options.generator.label_density); break;
+        case 'b': valid = parse_fraction(value, &options.generator.branch_ratio); break;
+        case 'c': valid = parse_fraction(value, &options.generator.comment_density); break;
+        case 'x': options.generator.seed = strtoull(value, &end, 0); valid = *end == '\0'; break;
+        case 'r': options.repeat = (int)strtol(value, &end, 10); valid = *end == '\0' && options.repeat > 0; break;
+        case 'd': options.directory = value; break;
+        case 'o': options.output = value; break;
+        }
+        if (!valid)
+        {
+            fprintf(stderr, "Invalid value for %s: %s\n", arg, value);
+            return 2;
+        }
+    }
+
+    BENCH_RESULT *results = calloc(options.size_count, sizeof(BENCH_RESULT));
+    if (results == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    fprintf(stderr, "%10s %12s %16s %16s %16s %10s\n", "lines", "bytes", "process lines/s", "assemble lines/s",
+            "interpret lines/s", "peak KB");
+    int done = 0;
+    for (; done < options.size_count; done++)
+    {
+        if (!run_size(&options, options.sizes[done], &results[done]))
+            break;
+        print_result(&results[done], stderr);
+    }
+
+    FILE *file = options.output != NULL ? fopen(options.output, "w") : stdout;
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening %s\n", options.output);
+        free(results);
+        return 1;
+    }
+    write_json(&options, results, done, file);
+    if (file != stdout)
+        fclose(file);
+    free(results);
+    return done == options.size_count ? 0 : 1;
+}
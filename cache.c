@@ -0,0 +1,424 @@
+/*======================================================================================================
+* FILE        : cache.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the --cache assembly cache. The source is read once and hashed; if an
+*               entry for the hash exists its machine code and diagnostics are used as they are, otherwise
+*               the source is assembled from the same text and the result is stored for next time.
+*
+*               Entry layout (little-endian): CACHE_MAGIC, 16-byte key, source size (8), flags (4, bit 0 is
+*               success), byte count, error count, dropped count and diagnostic count (4 each), then 5 bytes
+*               per machine code byte (address (4), value) and per diagnostic its severity (1), line (4),
+*               column (4), message length (2) and message.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - The -O level is part of the key.
+*   16 October, 2026: V1.2 - A miss only optimizes a program that assembled, as assemble() does.
+*   16 October, 2026: V1.3 - Machine code addresses are stored in 4 bytes (TRCACHE2).
+*   16 October, 2026: V1.4 - The key includes a hash of the executable, so a rebuild starts a fresh cache.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "allocator.h"
+#include "cache.h"
+#include "optimizer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#define make_directory(path)    _mkdir(path)
+#define process_id()            _getpid()
+#else
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+#include <sys/stat.h>
+#include <unistd.h>
+#define make_directory(path)    mkdir(path, 0777)
+#define process_id()            getpid()
+#endif
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define HASH_PRIME1     0x9E3779B185EBCA87ULL
+#define HASH_PRIME2     0xC2B2AE3D27D4EB4FULL
+#define HEADER_SIZE     52
+#define BYTE_SIZE       5
+#define ENTRY_FLAG_SUCCESS  1u
+
+static pthread_mutex_t temp_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int temp_count;     // Makes temporary names unique between the workers of one process
+static pthread_once_t build_once = PTHREAD_ONCE_INIT;
+static unsigned long long build_id[2];  // Hash of the running executable, zero if it cannot be read
+
+/*===============================================
+*   FUNCTION    :   rotate
+*   DESCRIPTION :   This function will rotate a 64-bit word left.
+*   ARGUMENTS   :   unsigned long long word, int bits
+*   RETURNS     :   unsigned long long
+ *==============================================*/
+static unsigned long long rotate(unsigned long long word, int bits)
+{
+    return (word << bits) | (word >> (64 - bits));
+}
+
+/*===============================================
+*   FUNCTION    :   avalanche
+*   DESCRIPTION :   This function will spread every bit of a hash lane over the whole word.
+*   ARGUMENTS   :   unsigned long long hash
+*   RETURNS     :   unsigned long long
+ *==============================================*/
+static unsigned long long avalanche(unsigned long long hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/*===============================================
+*   FUNCTION    :   hash_bytes
+*   DESCRIPTION :   This function will fold bytes into both hash lanes, eight at a time.
+*   ARGUMENTS   :   unsigned long long hash[2], const char *data, size_t size
+*   RETURNS     :   VOID
+ *==============================================*/
+static void hash_bytes(unsigned long long hash[2], const char *data, size_t size)
+{
+    size_t i = 0;
+    for (;;) {
+        unsigned long long word = 0;
+        size_t length = size - i < 8 ? size - i : 8;
+        memcpy(&word, data + i, length);
+        hash[0] = rotate(hash[0] ^ word * HASH_PRIME2, 31) * HASH_PRIME1;
+        hash[1] = rotate(hash[1] + word * HASH_PRIME1, 27) * HASH_PRIME2;
+        i += length;
+        if (length < 8)
+            break;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   executable_path
+*   DESCRIPTION :   This function will find the file the running program was loaded from.
+*   ARGUMENTS   :   char *path, size_t size
+*   RETURNS     :   bool (false if the platform cannot tell)
+ *==============================================*/
+static bool executable_path(char *path, size_t size)
+{
+#if defined(_WIN32)
+    DWORD length = GetModuleFileNameA(NULL, path, (DWORD)size);
+    return length > 0 && length < size;
+#elif defined(__APPLE__)
+    uint32_t length = (uint32_t)size;
+    return _NSGetExecutablePath(path, &length) == 0;
+#elif defined(__linux__)
+    snprintf(path, size, "/proc/self/exe");
+    return true;
+#else
+    (void)path;
+    (void)size;
+    return false;
+#endif
+}
+
+/*===============================================
+*   FUNCTION    :   hash_build
+*   DESCRIPTION :   This function will hash the running executable into build_id, so every rebuild of the
+*                   assembler gets keys of its own even when TRACSASM_VERSION stays the same.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   VOID
+ *==============================================*/
+static void hash_build(void)
+{
+    char path[4096];
+    SOURCE executable;
+    if (!executable_path(path, sizeof(path)) || !source_open(path, &executable))
+        return;
+    build_id[0] = HASH_PRIME1;
+    build_id[1] = HASH_PRIME2;
+    hash_bytes(build_id, executable.text, executable.size);
+    source_close(&executable);
+}
+
+/*===============================================
+*   FUNCTION    :   cache_key
+*   DESCRIPTION :   This function will hash source text together with the assembler version, entry layout and
+*                   executable, so a new or rebuilt assembler never reads entries made by an old one, and with
+*                   the -O level, since it changes the machine code.
+*   ARGUMENTS   :   const char *text, size_t size, int optimize
+*   RETURNS     :   CACHE_KEY
+ *==============================================*/
+CACHE_KEY cache_key(const char *text, size_t size, int optimize)
+{
+    static const char version[] = TRACSASM_VERSION " " CACHE_MAGIC;
+    char level = (char)optimize;
+    CACHE_KEY key = { { HASH_PRIME1, HASH_PRIME2 } };
+    pthread_once(&build_once, hash_build);
+    hash_bytes(key.hash, version, sizeof(version));
+    hash_bytes(key.hash, (const char *)build_id, sizeof(build_id));
+    hash_bytes(key.hash, &level, 1);
+    hash_bytes(key.hash, text, size);
+    key.hash[0] = avalanche(key.hash[0] ^ size);
+    key.hash[1] = avalanche(key.hash[1] ^ key.hash[0]);
+    return key;
+}
+
+/*===============================================
+*   FUNCTION    :   put
+*   DESCRIPTION :   This function will store a little-endian number of the given width in bytes.
+*   ARGUMENTS   :   unsigned char *buffer, unsigned long long value, int width
+*   RETURNS     :   unsigned char * (just past the number)
+ *==============================================*/
+static unsigned char *put(unsigned char *buffer, unsigned long long value, int width)
+{
+    for (int i = 0; i < width; i++)
+        buffer[i] = (unsigned char)(value >> (8 * i));
+    return buffer + width;
+}
+
+/*===============================================
+*   FUNCTION    :   get
+*   DESCRIPTION :   This function will load a little-endian number of the given width in bytes.
+*   ARGUMENTS   :   const unsigned char *buffer, int width
+*   RETURNS     :   unsigned long long
+ *==============================================*/
+static unsigned long long get(const unsigned char *buffer, int width)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < width; i++)
+        value |= (unsigned long long)buffer[i] << (8 * i);
+    return value;
+}
+
+/*===============================================
+*   FUNCTION    :   entry_path
+*   DESCRIPTION :   This function will build the file name of the entry for a key.
+*   ARGUMENTS   :   const char *directory, CACHE_KEY key
+*   RETURNS     :   char * (malloc'd, NULL if out of memory)
+ *==============================================*/
+static char *entry_path(const char *directory, CACHE_KEY key)
+{
+    size_t length = strlen(directory) + 1 + 32 + sizeof(CACHE_EXTENSION);
+    char *path = malloc(length);
+    if (path != NULL)
+        snprintf(path, length, "%s/%016llx%016llx" CACHE_EXTENSION, directory, key.hash[0], key.hash[1]);
+    return path;
+}
+
+/*===============================================
+*   FUNCTION    :   cache_load
+*   DESCRIPTION :   This function will read an entry into code and diagnostics. Missing, truncated or foreign
+*                   entries are a miss and leave both untouched.
+*   ARGUMENTS   :   const char *path, CACHE_KEY key, size_t size, MACHINE_CODE *code, DIAGNOSTICS *diagnostics,
+*                   bool *success
+*   RETURNS     :   bool (true on a hit)
+ *==============================================*/
+static bool cache_load(const char *path, CACHE_KEY key, size_t size, MACHINE_CODE *code, DIAGNOSTICS *diagnostics, bool *success)
+{
+    SOURCE entry;
+    if (!source_open(path, &entry))
+        return false;
+
+    const unsigned char *data = (const unsigned char *)entry.text;
+    const unsigned char *end = data + entry.size;
+    bool hit = entry.size >= HEADER_SIZE && memcmp(data, CACHE_MAGIC, 8) == 0 &&
+               get(data + 8, 8) == key.hash[0] && get(data + 16, 8) == key.hash[1] && get(data + 24, 8) == size;
+    unsigned int byte_count = hit ? (unsigned int)get(data + 36, 4) : 0;
+    hit = hit && byte_count % 2 == 0 && byte_count <= (size_t)(end - data - HEADER_SIZE) / BYTE_SIZE;
+    if (!hit) {
+        source_close(&entry);
+        return false;
+    }
+
+    // Check every diagnostic fits before anything is allocated
+    unsigned int diagnostic_count = (unsigned int)get(data + 48, 4);
+    const unsigned char *p = data + HEADER_SIZE + BYTE_SIZE * (size_t)byte_count;
+    for (unsigned int i = 0; i < diagnostic_count && hit; i++) {
+        hit = end - p >= 11 && (size_t)(end - p - 11) >= get(p + 9, 2);
+        if (hit)
+            p += 11 + get(p + 9, 2);
+    }
+    *success = (get(data + 32, 4) & ENTRY_FLAG_SUCCESS) != 0;
+    if (!hit || (*success && !initMachineCode(code, byte_count / 2, diagnostics->allocator))) {
+        source_close(&entry);
+        return false;
+    }
+
+    p = data + HEADER_SIZE;
+    if (*success) {
+        for (unsigned int i = 0; i < byte_count; i++, p += BYTE_SIZE) {
+            code->bytes[i].address = (unsigned int)get(p, 4);
+            code->bytes[i].value = p[4];
+        }
+        code->count = (int)byte_count;
+    }
+    p = data + HEADER_SIZE + BYTE_SIZE * (size_t)byte_count;
+    for (unsigned int i = 0; i < diagnostic_count; i++) {
+        int length = (int)get(p + 9, 2);
+        report_at(diagnostics, p[0] == TRACS_ERROR ? TRACS_ERROR : TRACS_WARNING, (unsigned int)get(p + 1, 4),
+                  (unsigned int)get(p + 5, 4), "%.*s", length, (const char *)p + 11);
+        p += 11 + length;
+    }
+    // The counts include messages that were past the limit when the entry was made
+    diagnostics->errors = (int)get(data + 40, 4);
+    diagnostics->dropped = (int)get(data + 44, 4);
+    source_close(&entry);
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   cache_store
+*   DESCRIPTION :   This function will write an entry for the result of one assembly. A temporary file is
+*                   renamed into place so readers never see half an entry; any failure just leaves no entry.
+*   ARGUMENTS   :   const char *path, CACHE_KEY key, size_t size, const MACHINE_CODE *code, const DIAGNOSTICS *diagnostics,
+*                   bool success
+*   RETURNS     :   VOID
+ *==============================================*/
+static void cache_store(const char *path, CACHE_KEY key, size_t size, const MACHINE_CODE *code, const DIAGNOSTICS *diagnostics, bool success)
+{
+    unsigned int byte_count = success ? (unsigned int)code->count : 0;
+    size_t length = HEADER_SIZE + BYTE_SIZE * (size_t)byte_count;
+    for (int i = 0; i < diagnostics->count; i++)
+        length += 11 + strlen(diagnostics->items[i].message);
+
+    unsigned char *buffer = malloc(length);
+    size_t temp_length = strlen(path) + 32;
+    char *temp = malloc(temp_length);
+    if (buffer == NULL || temp == NULL) {
+        free(buffer);
+        free(temp);
+        return;
+    }
+
+    unsigned char *p = buffer;
+    memcpy(p, CACHE_MAGIC, 8);
+    p = put(p + 8, key.hash[0], 8);
+    p = put(p, key.hash[1], 8);
+    p = put(p, size, 8);
+    p = put(p, success ? ENTRY_FLAG_SUCCESS : 0, 4);
+    p = put(p, byte_count, 4);
+    p = put(p, (unsigned int)diagnostics->errors, 4);
+    p = put(p, (unsigned int)diagnostics->dropped, 4);
+    p = put(p, (unsigned int)diagnostics->count, 4);
+    for (unsigned int i = 0; i < byte_count; i++) {
+        p = put(p, code->bytes[i].address, 4);
+        *p++ = code->bytes[i].value;
+    }
+    for (int i = 0; i < diagnostics->count; i++) {
+        const TRACS_DIAGNOSTIC *item = &diagnostics->items[i];
+        size_t message_length = strlen(item->message);
+        *p++ = (unsigned char)item->severity;
+        p = put(p, item->line, 4);
+        p = put(p, item->column, 4);
+        p = put(p, message_length, 2);
+        memcpy(p, item->message, message_length);
+        p += message_length;
+    }
+
+    // Workers and other processes may store the same entry at once; each writes its own temporary file
+    pthread_mutex_lock(&temp_lock);
+    unsigned int count = temp_count++;
+    pthread_mutex_unlock(&temp_lock);
+    snprintf(temp, temp_length, "%s.%d.%u.tmp", path, (int)process_id(), count);
+    FILE *file = fopen(temp, "wb");
+    if (file != NULL) {
+        bool written = fwrite(buffer, 1, length, file) == length;
+        written = fclose(file) == 0 && written;
+#ifdef _WIN32
+        if (written)
+            remove(path);
+#endif
+        if (!written || rename(temp, path) != 0)
+            remove(temp);
+    }
+    free(buffer);
+    free(temp);
+}
+
+/*===============================================
+*   FUNCTION    :   cache_init
+*   DESCRIPTION :   This function will create the cache directory if it does not exist yet.
+*   ARGUMENTS   :   const char *directory
+*   RETURNS     :   bool
+ *==============================================*/
+bool cache_init(const char *directory)
+{
+    return make_directory(directory) == 0 || errno == EEXIST;
+}
+
+/*===============================================
+*   FUNCTION    :   cache_assemble
+*   DESCRIPTION :   This function does what assemble() does, but serves unchanged sources from the cache in
+*                   directory. The source is read once: it is hashed, and on a miss the same text is tokenized
+*                   and encoded, and the result (failures included) is stored. With stats, a hit shows up as
+*                   a read phase and nothing else.
+*   ARGUMENTS   :   const char *directory, const char *filename, MACHINE_CODE *code, const TRACS_ALLOCATOR *allocator,
+*                   int optimize, STATS *stats (NULL for none)
+*   RETURNS     :   int
+ *==============================================*/
+int cache_assemble(const char *directory, const char *filename, MACHINE_CODE *code, const TRACS_ALLOCATOR *allocator, int optimize, STATS *stats)
+{
+    bool success = false;
+    PROGRAM program;
+    DIAGNOSTICS diagnostics;
+    if (allocator == NULL)
+        allocator = &heap_allocator;
+    if (stats != NULL) {
+        stats->backing = allocator;
+        allocator = &stats->allocator;
+    }
+    diagnostics_init(&diagnostics, allocator);
+    diagnostics.limit = DIAGNOSTIC_LIMIT;
+    memset(&program, 0, sizeof(program));
+    program.allocator = allocator;
+
+    stats_begin(stats, STATS_READ);
+    bool opened = source_open(filename, &program.source);
+    int error = errno;
+    size_t size = program.source.size;
+    CACHE_KEY key = cache_key(program.source.text, size, optimize);
+    char *path = opened ? entry_path(directory, key) : NULL;
+    bool hit = path != NULL && cache_load(path, key, size, code, &diagnostics, &success);
+    stats_end(stats, 0, size);
+
+    if (!opened) {
+        report(&diagnostics, TRACS_ERROR, 0, "Cannot open file: %s", strerror(error));
+    }
+    else if (!hit) {
+        stats_begin(stats, STATS_TOKENIZE);
+        bool tokenized = tokenize_program(&program, &diagnostics);
+        stats_end(stats, program.line_count, size);
+        if (tokenized) {
+            stats_begin(stats, STATS_ENCODE);
+            success = assemble_program(&program, code, &diagnostics);
+            stats_end(stats, program.line_count, success ? code->count : 0);
+        }
+        if (success && optimize > OPTIMIZE_NONE) {
+            stats_begin(stats, STATS_OPTIMIZE);
+            optimize_program(&program, optimize, code, &diagnostics);
+            stats_end(stats, program.line_count, code->count);
+        }
+        if (path != NULL)
+            cache_store(path, key, size, code, &diagnostics, success);
+    }
+    free_program(&program);
+    free(path);
+
+    diagnostics_sort(&diagnostics);
+    print_diagnostics(&diagnostics, strcmp(filename, "-") == 0 ? "<stdin>" : filename, stderr);
+    diagnostics_free(&diagnostics);
+    return success;
+}
@@ -0,0 +1,29 @@
+#ifndef CACHE_H
+#define CACHE_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdbool.h>
+#include "assembler.h"
+
+#define CACHE_MAGIC         "TRCACHE2"  // Changes whenever the entry layout does
+#define CACHE_EXTENSION     ".tce"
+
+/*
+ * On-disk cache of finished assemblies, one file per entry, named after a 128-bit hash of the source
+ * bytes, the assembler version and executable, and the -O level. An entry holds the machine code and the
+ * diagnostics, so a hit skips tokenizing, optimizing and encoding. Entries are written to a temporary file
+ * and renamed into place, so any number of workers and processes may share one directory.
+ */
+typedef struct cacheKey {
+    unsigned long long hash[2];
+} CACHE_KEY;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+bool cache_init(const char *directory);
+CACHE_KEY cache_key(const char *text, size_t size, int optimize);
+int cache_assemble(const char *directory, const char *filename, MACHINE_CODE *code, const TRACS_ALLOCATOR *allocator, int optimize, STATS *stats);
+
+#endif
@@ -0,0 +1,204 @@
+/*======================================================================================================
+* FILE        : diagnostics.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the diagnostics list the assembler reports errors and warnings into,
+*               instead of printing them as it goes. The list is sorted into source order before it is shown.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Columns, a message limit and sorting by line and column.
+*   16 October, 2026: V1.2 - print_diagnostics() writes the list under the stream's lock.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include "allocator.h"
+#include "diagnostics.h"
+
+/*===============================================
+*   FUNCTION    :   diagnostics_init
+*   DESCRIPTION :   This function will create an empty diagnostics list.
+*   ARGUMENTS   :   DIAGNOSTICS *diagnostics, const TRACS_ALLOCATOR *allocator
+*   RETURNS     :   VOID
+ *==============================================*/
+void diagnostics_init(DIAGNOSTICS *diagnostics, const TRACS_ALLOCATOR *allocator)
+{
+    memset(diagnostics, 0, sizeof(*diagnostics));
+    diagnostics->allocator = allocator;
+}
+
+/*===============================================
+*   FUNCTION    :   diagnostics_free
+*   DESCRIPTION :   This function will release every message and the list itself.
+*   ARGUMENTS   :   DIAGNOSTICS *diagnostics
+*   RETURNS     :   VOID
+ *==============================================*/
+void diagnostics_free(DIAGNOSTICS *diagnostics)
+{
+    for (int i = 0; i < diagnostics->count; i++)
+        RELEASE(diagnostics->allocator, diagnostics->items[i].message);
+    if (diagnostics->items != NULL)
+        RELEASE(diagnostics->allocator, diagnostics->items);
+    diagnostics_init(diagnostics, diagnostics->allocator);
+}
+
+/*===============================================
+*   FUNCTION    :   add_diagnostic
+*   DESCRIPTION :   This function will format a diagnostic and add it to the list. Past the list's limit only
+*                   the count of dropped messages goes up; errors are counted either way.
+*   ARGUMENTS   :   DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, unsigned int column,
+*                   const char *format, va_list args
+*   RETURNS     :   VOID
+ *==============================================*/
+static void add_diagnostic(DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, unsigned int column,
+                           const char *format, va_list args)
+{
+    if (severity == TRACS_ERROR)
+        diagnostics->errors++;
+    if (diagnostics->limit != 0 && diagnostics->count >= diagnostics->limit) {
+        diagnostics->dropped++;
+        return;
+    }
+
+    if (diagnostics->count == diagnostics->capacity) {
+        int capacity = diagnostics->capacity ? diagnostics->capacity * 2 : 16;
+        TRACS_DIAGNOSTIC *items = REALLOCATE(diagnostics->allocator, diagnostics->items,
+                                             diagnostics->capacity * sizeof(TRACS_DIAGNOSTIC), capacity * sizeof(TRACS_DIAGNOSTIC));
+        if (items == NULL)
+            return;
+        diagnostics->items = items;
+        diagnostics->capacity = capacity;
+    }
+
+    char buffer[DIAGNOSTIC_MESSAGE_LENGTH];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+
+    size_t length = strlen(buffer) + 1;
+    char *message = ALLOCATE(diagnostics->allocator, length);
+    if (message == NULL)
+        return;
+    memcpy(message, buffer, length);
+
+    TRACS_DIAGNOSTIC *item = &diagnostics->items[diagnostics->count++];
+    item->severity = severity;
+    item->line = line;
+    item->column = column;
+    item->message = message;
+}
+
+/*===============================================
+*   FUNCTION    :   report
+*   DESCRIPTION :   This function will add a printf-formatted diagnostic for a whole line to the list.
+*   ARGUMENTS   :   DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, const char *format, ...
+*   RETURNS     :   VOID
+ *==============================================*/
+void report(DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    add_diagnostic(diagnostics, severity, line, 0, format, args);
+    va_end(args);
+}
+
+/*===============================================
+*   FUNCTION    :   report_at
+*   DESCRIPTION :   This function will add a printf-formatted diagnostic for one column of a line to the list.
+*   ARGUMENTS   :   DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, unsigned int column,
+*                   const char *format, ...
+*   RETURNS     :   VOID
+ *==============================================*/
+void report_at(DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, unsigned int column, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    add_diagnostic(diagnostics, severity, line, column, format, args);
+    va_end(args);
+}
+
+/*===============================================
+*   FUNCTION    :   diagnostic_before
+*   DESCRIPTION :   This function will tell whether a belongs before b: by line, then by column. Problems that
+*                   are not tied to a line come first.
+*   ARGUMENTS   :   const TRACS_DIAGNOSTIC *a, const TRACS_DIAGNOSTIC *b
+*   RETURNS     :   bool
+ *==============================================*/
+static bool diagnostic_before(const TRACS_DIAGNOSTIC *a, const TRACS_DIAGNOSTIC *b)
+{
+    if (a->line != b->line)
+        return a->line < b->line;
+    return a->column < b->column;
+}
+
+/*===============================================
+*   FUNCTION    :   diagnostics_sort
+*   DESCRIPTION :   This function will put the list in source order. Diagnostics are mostly reported in order
+*                   already (fixups and unknown labels are the exceptions), so this is a stable bottom-up merge
+*                   sort that keeps the report order of diagnostics on the same column. If the scratch buffer
+*                   cannot be allocated the list is left as reported.
+*   ARGUMENTS   :   DIAGNOSTICS *diagnostics
+*   RETURNS     :   VOID
+ *==============================================*/
+void diagnostics_sort(DIAGNOSTICS *diagnostics)
+{
+    int count = diagnostics->count;
+    if (count < 2)
+        return;
+    TRACS_DIAGNOSTIC *scratch = ALLOCATE(diagnostics->allocator, count * sizeof(TRACS_DIAGNOSTIC));
+    if (scratch == NULL)
+        return;
+
+    TRACS_DIAGNOSTIC *from = diagnostics->items;
+    TRACS_DIAGNOSTIC *to = scratch;
+    for (int width = 1; width < count; width *= 2) {
+        for (int low = 0; low < count; low += 2 * width) {
+            int middle = low + width < count ? low + width : count;
+            int high = low + 2 * width < count ? low + 2 * width : count;
+            int i = low, j = middle, k = low;
+            while (i < middle && j < high)
+                to[k++] = diagnostic_before(&from[j], &from[i]) ? from[j++] : from[i++];
+            while (i < middle)
+                to[k++] = from[i++];
+            while (j < high)
+                to[k++] = from[j++];
+        }
+        TRACS_DIAGNOSTIC *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != diagnostics->items)
+        memcpy(diagnostics->items, from, count * sizeof(TRACS_DIAGNOSTIC));
+    RELEASE(diagnostics->allocator, scratch);
+}
+
+/*===============================================
+*   FUNCTION    :   print_diagnostics
+*   DESCRIPTION :   This function will print the list as "file:line:column: error: message" lines, followed by
+*                   the number of messages dropped past the limit, if any. The stream is locked throughout, so
+*                   the lists of inputs assembled at once are not mixed.
+*   ARGUMENTS   :   const DIAGNOSTICS *diagnostics, const char *filename, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void print_diagnostics(const DIAGNOSTICS *diagnostics, const char *filename, FILE *file)
+{
+    flockfile(file);
+    for (int i = 0; i < diagnostics->count; i++) {
+        const TRACS_DIAGNOSTIC *item = &diagnostics->items[i];
+        const char *severity = item->severity == TRACS_ERROR ? "error" : "warning";
+        if (item->line != 0 && item->column != 0)
+            fprintf(file, "%s:%u:%u: %s: %s\n", filename, item->line, item->column, severity, item->message);
+        else if (item->line != 0)
+            fprintf(file, "%s:%u: %s: %s\n", filename, item->line, severity, item->message);
+        else
+            fprintf(file, "%s: %s: %s\n", filename, severity, item->message);
+    }
+    if (diagnostics->dropped != 0)
+        fprintf(file, "%s: note: %d more diagnostic%s not shown (%d error%s in total)\n", filename,
+                diagnostics->dropped, diagnostics->dropped == 1 ? "" : "s", diagnostics->errors, diagnostics->errors == 1 ? "" : "s");
+    funlockfile(file);
+}
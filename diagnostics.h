@@ -0,0 +1,44 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdio.h>
+#include "tracsasm.h"
+
+#define DIAGNOSTIC_MESSAGE_LENGTH 256
+#define DIAGNOSTIC_LIMIT          100   // Messages the command line keeps per input
+
+// Pool workers print whole blocks under the stream's lock, so blocks of different inputs do not interleave
+#ifdef _WIN32
+#define flockfile   _lock_file
+#define funlockfile _unlock_file
+#endif
+
+typedef struct diagnostics {
+    TRACS_DIAGNOSTIC *items;
+    int count;
+    int capacity;
+    int errors;                 // Counted even when the message itself could not be stored
+    const TRACS_ALLOCATOR *allocator;
+    int limit;                  // Messages kept at most, 0 for all of them
+    int dropped;                // Reported after the limit was reached
+} DIAGNOSTICS;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void diagnostics_init(DIAGNOSTICS *diagnostics, const TRACS_ALLOCATOR *allocator);
+void diagnostics_free(DIAGNOSTICS *diagnostics);
+#if defined(__GNUC__)
+__attribute__((format(printf, 4, 5)))
+#endif
+void report(DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, const char *format, ...);
+#if defined(__GNUC__)
+__attribute__((format(printf, 5, 6)))
+#endif
+void report_at(DIAGNOSTICS *diagnostics, TRACS_SEVERITY severity, unsigned int line, unsigned int column, const char *format, ...);
+void diagnostics_sort(DIAGNOSTICS *diagnostics);
+void print_diagnostics(const DIAGNOSTICS *diagnostics, const char *filename, FILE *file);
+
+#endif
@@ -0,0 +1,817 @@
+/*======================================================================================================
+* FILE        : difftest.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the differential test harness (the Difftest target). It generates seeded
+*               random TRACS programs and checks that every way of building and running one agrees:
+*                 levels  - each -O level leaves the same registers, flags, data and I/O as -O0,
+*                 engines - the simulator, the threaded interpreter and the JIT end in the same state,
+*                 watch   - a --watch build patched after an edit has the same machine code as a full assembly,
+*                 seeds   - the programs behind earlier optimizer fixes fail at every level, and no pass
+*                           removes the line with the unknown label.
+*
+*               Programs only branch forward, apart from one counted loop, so they always reach EOP; the
+*               engine check also runs variants that write into their own code. The same seed gives the same
+*               programs, so a failure is reproduced with -x SEED -n 1.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include "allocator.h"
+#include "assembler.h"
+#include "optimizer.h"
+#include "simulator.h"
+#include "threaded.h"
+#include "jit.h"
+#include "watch.h"
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define DIFF_MAX_LINES      160
+#define DIFF_LABEL_SIZE     8
+#define DIFF_TEXT_SIZE      24
+#define DIFF_DATA           0x400   // First data cell the programs use
+#define DIFF_CODE_CELLS     0x40    // Addresses a self-modifying program may write, all inside its code
+#define DIFF_SHOWN          5       // Failures printed with their program; the rest are only counted
+#define DIFF_WATCH_FILE     "difftest_watch.asm"
+
+typedef enum diffCheckId {
+    CHECK_LEVELS,
+    CHECK_ENGINES,
+    CHECK_WATCH,
+    CHECK_SEEDS,
+    CHECK_COUNT
+} DIFF_CHECK_ID;
+
+typedef struct diffLine {
+    char label[DIFF_LABEL_SIZE];    // Empty if the line defines no label
+    char text[DIFF_TEXT_SIZE];      // Instruction and operand
+} DIFF_LINE;
+
+typedef struct diffProgram {
+    DIFF_LINE lines[DIFF_MAX_LINES];
+    int count;
+    int cells;                      // Data cells from DIFF_DATA the instructions name
+    bool self_modifying;            // WM and RM may also name the program's own code
+} DIFF_PROGRAM;
+
+typedef struct diffOptions {
+    unsigned long long seed;
+    long programs;
+    int edits;                      // --watch edits per program
+    unsigned long long step_limit;
+    const char *directory;          // Where the --watch check writes its file
+} DIFF_OPTIONS;
+
+typedef struct diffHarness {
+    const DIFF_OPTIONS *options;
+    long runs[CHECK_COUNT];
+    long failures[CHECK_COUNT];
+    long patched;                   // --watch edits that were patched in rather than assembled again
+    int shown;
+    THREADED_CODE *threaded;
+    JIT *jit;                       // NULL where the JIT is not available
+    MACHINE *machines;              // Scratch machines, one per engine and one for -O0
+} DIFF_HARNESS;
+
+typedef struct seedCase {
+    const char *text;
+    const char *label;              // Unknown label the program names; its line must survive every pass
+} SEED_CASE;
+
+static const char *checkNames[CHECK_COUNT] = { "levels", "engines", "watch", "seeds" };
+static const char *fillers[] = { "WACC", "RACC", "ADD", "SUB", "MUL", "AND", "OR", "NOT", "XOR", "SHL", "SHR", "SWAP" };
+static const char *branches[] = { "BR", "BRE", "BRNE", "BRGT", "BRLT" };
+
+static const SEED_CASE seeds[] = {
+    { "ORG 0x100\nRM foo\nRM 0x400\nWB 0x1f\nWB 0x2\nEOP\n", "foo" },
+    { "ORG 0x100\nWB 0x5\nWM foo\nWB 0x6\nWM 0x000\nEOP\n", "foo" },
+    { "WB 0x1\nBR done\nBRE nowhere\nWACC\ndone EOP\n", "nowhere" },
+};
+
+/*===============================================
+*   FUNCTION    :   next_random
+*   DESCRIPTION :   This function will step a xorshift64 generator.
+*   ARGUMENTS   :   unsigned long long *state
+*   RETURNS     :   unsigned long long
+ *==============================================*/
+static unsigned long long next_random(unsigned long long *state)
+{
+    unsigned long long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/*===============================================
+*   FUNCTION    :   chance
+*   DESCRIPTION :   This function will return true with the given probability.
+*   ARGUMENTS   :   unsigned long long *state, double probability
+*   RETURNS     :   bool
+ *==============================================*/
+static bool chance(unsigned long long *state, double probability)
+{
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0) < probability;
+}
+
+/*===============================================
+*   FUNCTION    :   pick
+*   DESCRIPTION :   This function will return a number from 0 to count - 1.
+*   ARGUMENTS   :   unsigned long long *state, unsigned int count
+*   RETURNS     :   unsigned int
+ *==============================================*/
+static unsigned int pick(unsigned long long *state, unsigned int count)
+{
+    return (unsigned int)((next_random(state) >> 16) % count);
+}
+
+/*===============================================
+*   FUNCTION    :   seed_state
+*   DESCRIPTION :   This function will start the generator for one seed; neighbouring seeds give unrelated programs.
+*   ARGUMENTS   :   unsigned long long seed
+*   RETURNS     :   unsigned long long
+ *==============================================*/
+static unsigned long long seed_state(unsigned long long seed)
+{
+    unsigned long long state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    for (int i = 0; i < 8; i++)
+        next_random(&state);
+    return state;
+}
+
+/*===============================================
+*   FUNCTION    :   set_line
+*   DESCRIPTION :   This function will fill in one line from a label (NULL for none) and a printf-style instruction.
+*   ARGUMENTS   :   DIFF_LINE *line, const char *label, const char *format, ...
+*   RETURNS     :   VOID
+ *==============================================*/
+static void set_line(DIFF_LINE *line, const char *label, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    snprintf(line->label, sizeof(line->label), "%s", label != NULL ? label : "");
+    vsnprintf(line->text, sizeof(line->text), format, args);
+    va_end(args);
+}
+
+/*===============================================
+*   FUNCTION    :   add_line
+*   DESCRIPTION :   This function will append a line, unless the program is already full.
+*   ARGUMENTS   :   DIFF_PROGRAM *program, const char *label, const char *text
+*   RETURNS     :   VOID
+ *==============================================*/
+static void add_line(DIFF_PROGRAM *program, const char *label, const char *text)
+{
+    if (program->count < DIFF_MAX_LINES)
+        set_line(&program->lines[program->count++], label, "%s", text);
+}
+
+/*===============================================
+*   FUNCTION    :   random_address
+*   DESCRIPTION :   This function will pick the address a WM or RM names.
+*   ARGUMENTS   :   const DIFF_PROGRAM *program, unsigned long long *state
+*   RETURNS     :   unsigned int
+ *==============================================*/
+static unsigned int random_address(const DIFF_PROGRAM *program, unsigned long long *state)
+{
+    if (program->self_modifying && chance(state, 0.3))
+        return pick(state, DIFF_CODE_CELLS);
+    return DIFF_DATA + pick(state, (unsigned int)program->cells);
+}
+
+/*===============================================
+*   FUNCTION    :   random_instruction
+*   DESCRIPTION :   This function will write one instruction that does not branch.
+*   ARGUMENTS   :   const DIFF_PROGRAM *program, unsigned long long *state, char *text, size_t size
+*   RETURNS     :   VOID
+ *==============================================*/
+static void random_instruction(const DIFF_PROGRAM *program, unsigned long long *state, char *text, size_t size)
+{
+    switch (pick(state, 11)) {
+    case 0:
+    case 1:  snprintf(text, size, "WB 0x%02x", pick(state, 256)); break;
+    case 2:
+    case 3:  snprintf(text, size, "WM 0x%03x", random_address(program, state)); break;
+    case 4:
+    case 5:  snprintf(text, size, "RM 0x%03x", random_address(program, state)); break;
+    case 6:  snprintf(text, size, "WIB 0x%02x", pick(state, 256)); break;
+    case 7:  snprintf(text, size, "WIO 0x%x", pick(state, 4)); break;
+    default: snprintf(text, size, "%s", fillers[pick(state, sizeof(fillers) / sizeof(fillers[0]))]); break;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   generate_body
+*   DESCRIPTION :   This function will append a run of instructions. Some lines get a label named after prefix,
+*                   and branches only go forward to those labels, so the run always falls out of its end.
+*   ARGUMENTS   :   DIFF_PROGRAM *program, unsigned long long *state, int lines, char prefix
+*   RETURNS     :   VOID
+ *==============================================*/
+static void generate_body(DIFF_PROGRAM *program, unsigned long long *state, int lines, char prefix)
+{
+    if (program->count + lines > DIFF_MAX_LINES)
+        lines = DIFF_MAX_LINES - program->count;
+    bool labelled[DIFF_MAX_LINES];
+    for (int i = 0; i < lines; i++)
+        labelled[i] = i > 0 && chance(state, 0.2);
+
+    for (int i = 0; i < lines; i++) {
+        DIFF_LINE *line = &program->lines[program->count + i];
+        char label[DIFF_LABEL_SIZE];
+        snprintf(label, sizeof(label), "%c%d", prefix, i);
+
+        int later = 0;
+        for (int j = i + 1; j < lines; j++)
+            later += labelled[j];
+        if (later > 0 && chance(state, 0.15)) {
+            int target = i + 1, skip = (int)pick(state, (unsigned int)later);
+            while (!labelled[target] || skip-- > 0)
+                target++;
+            set_line(line, labelled[i] ? label : NULL, "%s %c%d", branches[pick(state, 5)], prefix, target);
+        }
+        else {
+            char text[DIFF_TEXT_SIZE];
+            random_instruction(program, state, text, sizeof(text));
+            set_line(line, labelled[i] ? label : NULL, "%s", text);
+        }
+    }
+    program->count += lines;
+}
+
+/*===============================================
+*   FUNCTION    :   generate_program
+*   DESCRIPTION :   This function will build the program for a seed: a run of instructions, then maybe a loop
+*                   counted in memory and a block moved by ORG, then a last run and EOP.
+*   ARGUMENTS   :   DIFF_PROGRAM *program, unsigned long long seed, bool self_modifying
+*   RETURNS     :   VOID
+ *==============================================*/
+static void generate_program(DIFF_PROGRAM *program, unsigned long long seed, bool self_modifying)
+{
+    unsigned long long state = seed_state(seed);
+    program->count = 0;
+    program->self_modifying = self_modifying;
+    program->cells = 1 + (int)pick(&state, 3);
+
+    generate_body(program, &state, 3 + (int)pick(&state, 23), 'A');
+    if (chance(&state, 0.5)) {
+        char limit[DIFF_TEXT_SIZE];
+        snprintf(limit, sizeof(limit), "WB 0x%x", 1 + pick(&state, 5));
+        add_line(program, NULL, "WB 0x00");
+        add_line(program, NULL, "WM 0x410");
+        add_line(program, "LOOP", "RM 0x410");
+        add_line(program, NULL, "WACC");
+        add_line(program, NULL, "WB 0x01");
+        add_line(program, NULL, "ADD");
+        add_line(program, NULL, "RACC");
+        add_line(program, NULL, "WM 0x410");
+        generate_body(program, &state, 2 + (int)pick(&state, 19), 'B');
+        add_line(program, NULL, "RM 0x410");
+        add_line(program, NULL, "WACC");
+        add_line(program, NULL, limit);
+        add_line(program, NULL, "BRLT LOOP");
+    }
+    if (chance(&state, 0.4)) {
+        add_line(program, NULL, "BR FAR");
+        add_line(program, NULL, "ORG 0x300");
+        add_line(program, "FAR", "WACC");
+        generate_body(program, &state, 2 + (int)pick(&state, 19), 'C');
+    }
+    generate_body(program, &state, 1 + (int)pick(&state, 15), 'D');
+    add_line(program, NULL, "EOP");
+}
+
+/*===============================================
+*   FUNCTION    :   render
+*   DESCRIPTION :   This function will write the program out as source text.
+*   ARGUMENTS   :   const DIFF_PROGRAM *program, char *text, size_t capacity
+*   RETURNS     :   size_t (length of the text)
+ *==============================================*/
+static size_t render(const DIFF_PROGRAM *program, char *text, size_t capacity)
+{
+    size_t size = 0;
+    for (int i = 0; i < program->count && size < capacity; i++) {
+        const DIFF_LINE *line = &program->lines[i];
+        int length = line->label[0] != '\0' ? snprintf(text + size, capacity - size, "%s %s\n", line->label, line->text)
+                                            : snprintf(text + size, capacity - size, "%s\n", line->text);
+        size += length > 0 ? (size_t)length : 0;
+    }
+    return size < capacity ? size : capacity - 1;
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_text
+*   DESCRIPTION :   This function will assemble source text in memory the way assemble() does a file, without
+*                   printing anything.
+*   ARGUMENTS   :   const char *text, size_t size, int optimize, MACHINE_CODE *code
+*   RETURNS     :   bool
+ *==============================================*/
+static bool assemble_text(const char *text, size_t size, int optimize, MACHINE_CODE *code)
+{
+    PROGRAM program;
+    DIAGNOSTICS diagnostics;
+    bool success = false;
+    diagnostics_init(&diagnostics, &heap_allocator);
+    if (process_buffer(text, size, &heap_allocator, &program, &diagnostics)) {
+        success = assemble_program(&program, code, &diagnostics);
+        if (success && optimize > OPTIMIZE_NONE)
+            optimize_program(&program, optimize, code, &diagnostics);
+        free_program(&program);
+    }
+    diagnostics_free(&diagnostics);
+    return success;
+}
+
+/*===============================================
+*   FUNCTION    :   fail
+*   DESCRIPTION :   This function will count a failed check and, for the first DIFF_SHOWN, print it with its program.
+*   ARGUMENTS   :   DIFF_HARNESS *harness, DIFF_CHECK_ID check, unsigned long long seed, const char *text,
+*                   size_t size, const char *format, ...
+*   RETURNS     :   VOID
+ *==============================================*/
+static void fail(DIFF_HARNESS *harness, DIFF_CHECK_ID check, unsigned long long seed, const char *text, size_t size,
+                 const char *format, ...)
+{
+    harness->failures[check]++;
+    if (harness->shown++ >= DIFF_SHOWN)
+        return;
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%s: seed %llu: ", checkNames[check], seed);
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n%.*s\n", (int)size, text);
+    va_end(args);
+}
+
+/*===============================================
+*   FUNCTION    :   same_machine
+*   DESCRIPTION :   This function will compare two machines in full, PC and step count included.
+*   ARGUMENTS   :   const MACHINE *a, const MACHINE *b
+*   RETURNS     :   bool
+ *==============================================*/
+static bool same_machine(const MACHINE *a, const MACHINE *b)
+{
+    return a->status == b->status && a->pc == b->pc && a->steps == b->steps && a->acc == b->acc && a->mbr == b->mbr &&
+           a->iob == b->iob && a->flags == b->flags && memcmp(a->memory, b->memory, TRACS_MEMORY_SIZE) == 0 &&
+           memcmp(a->io, b->io, TRACS_MEMORY_SIZE) == 0;
+}
+
+/*===============================================
+*   FUNCTION    :   describe_difference
+*   DESCRIPTION :   This function will name the first part of machine a that differs from b, with both values.
+*   ARGUMENTS   :   const MACHINE *a, const MACHINE *b, char *text, size_t size
+*   RETURNS     :   VOID
+ *==============================================*/
+static void describe_difference(const MACHINE *a, const MACHINE *b, char *text, size_t size)
+{
+    if (a->status != b->status)
+        snprintf(text, size, "status %s, not %s", sim_status_name(a->status), sim_status_name(b->status));
+    else if (a->steps != b->steps)
+        snprintf(text, size, "%llu instructions, not %llu", a->steps, b->steps);
+    else if (a->pc != b->pc)
+        snprintf(text, size, "PC = 0x%03x, not 0x%03x", a->pc, b->pc);
+    else if (a->acc != b->acc || a->mbr != b->mbr || a->iob != b->iob || a->flags != b->flags)
+        snprintf(text, size, "ACC/MBR/IOB/FLAGS = %02x/%02x/%02x/%x, not %02x/%02x/%02x/%x", a->acc, a->mbr, a->iob, a->flags,
+                 b->acc, b->mbr, b->iob, b->flags);
+    else {
+        snprintf(text, size, "the same state");
+        for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+            if (a->memory[address] != b->memory[address]) {
+                snprintf(text, size, "MEM[0x%03x] = 0x%02x, not 0x%02x", address, a->memory[address], b->memory[address]);
+                return;
+            }
+            if (a->io[address] != b->io[address]) {
+                snprintf(text, size, "IO[0x%03x] = 0x%02x, not 0x%02x", address, a->io[address], b->io[address]);
+                return;
+            }
+        }
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   same_outcome
+*   DESCRIPTION :   This function will compare what two builds of one program left behind: status, registers,
+*                   flags, I/O and every memory location either run changed. PC, step count and the code
+*                   itself may differ.
+*   ARGUMENTS   :   const MACHINE *a, const unsigned char *a_initial, const MACHINE *b, const unsigned char *b_initial
+*   RETURNS     :   bool
+ *==============================================*/
+static bool same_outcome(const MACHINE *a, const unsigned char *a_initial, const MACHINE *b, const unsigned char *b_initial)
+{
+    if (a->status != b->status || a->acc != b->acc || a->mbr != b->mbr || a->iob != b->iob || a->flags != b->flags ||
+        memcmp(a->io, b->io, TRACS_MEMORY_SIZE) != 0)
+        return false;
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+        bool a_changed = a->memory[address] != a_initial[address];
+        bool b_changed = b->memory[address] != b_initial[address];
+        if (a_changed != b_changed || (a_changed && a->memory[address] != b->memory[address]))
+            return false;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   check_engines
+*   DESCRIPTION :   This function will run the code on the simulator, the threaded interpreter and the JIT, and
+*                   leave the simulator's final state in harness->machines[0] and its loaded image in initial.
+*   ARGUMENTS   :   DIFF_HARNESS *harness, const MACHINE_CODE *code, unsigned long long seed, const char *text,
+*                   size_t size, unsigned char *initial
+*   RETURNS     :   bool (false if the code does not fit in memory)
+ *==============================================*/
+static bool check_engines(DIFF_HARNESS *harness, const MACHINE_CODE *code, unsigned long long seed, const char *text, size_t size,
+                          unsigned char *initial)
+{
+    MACHINE *simulated = &harness->machines[0], *threaded = &harness->machines[1], *compiled = &harness->machines[2];
+    unsigned long long limit = harness->options->step_limit;
+    char difference[96];
+    if (!sim_load(simulated, code))
+        return false;
+    memcpy(initial, simulated->memory, TRACS_MEMORY_SIZE);
+    sim_run(simulated, limit);
+
+    harness->runs[CHECK_ENGINES]++;
+    sim_load(threaded, code);
+    threaded_init(harness->threaded);
+    threaded_run(harness->threaded, threaded, limit);
+    if (!same_machine(simulated, threaded)) {
+        describe_difference(threaded, simulated, difference, sizeof(difference));
+        fail(harness, CHECK_ENGINES, seed, text, size, "threaded ends with %s", difference);
+    }
+
+    if (harness->jit != NULL) {
+        harness->runs[CHECK_ENGINES]++;
+        sim_load(compiled, code);
+        jit_run(harness->jit, compiled, limit);
+        if (!same_machine(simulated, compiled)) {
+            describe_difference(compiled, simulated, difference, sizeof(difference));
+            fail(harness, CHECK_ENGINES, seed, text, size, "the JIT ends with %s", difference);
+        }
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   check_levels
+*   DESCRIPTION :   This function will assemble a program at -O0 and at every -O level, check each build on all
+*                   the engines, and compare what each level left behind with -O0.
+*   ARGUMENTS   :   DIFF_HARNESS *harness, const DIFF_PROGRAM *program, unsigned long long seed
+*   RETURNS     :   VOID
+ *==============================================*/
+static void check_levels(DIFF_HARNESS *harness, const DIFF_PROGRAM *program, unsigned long long seed)
+{
+    char text[DIFF_MAX_LINES * (DIFF_LABEL_SIZE + DIFF_TEXT_SIZE + 2)];
+    size_t size = render(program, text, sizeof(text));
+    unsigned char reference_initial[TRACS_MEMORY_SIZE], initial[TRACS_MEMORY_SIZE];
+    MACHINE *reference = &harness->machines[3];
+    MACHINE_CODE code;
+
+    harness->runs[CHECK_LEVELS]++;
+    for (int level = OPTIMIZE_NONE; level <= OPTIMIZE_MAX; level++) {
+        if (!assemble_text(text, size, level, &code)) {
+            fail(harness, CHECK_LEVELS, seed, text, size, "-O%d does not assemble", level);
+            return;
+        }
+        bool loaded = check_engines(harness, &code, seed, text, size, initial);
+        freeMachineCode(&code);
+        if (!loaded) {
+            fail(harness, CHECK_LEVELS, seed, text, size, "-O%d does not fit in memory", level);
+            return;
+        }
+        if (level == OPTIMIZE_NONE) {
+            *reference = harness->machines[0];
+            memcpy(reference_initial, initial, TRACS_MEMORY_SIZE);
+        }
+        else if (!same_outcome(reference, reference_initial, &harness->machines[0], initial)) {
+            fail(harness, CHECK_LEVELS, seed, text, size, "-O%d differs from -O0", level);
+            return;
+        }
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   check_self_modifying
+*   DESCRIPTION :   This function will compare the engines on a program that writes into its own code. Only
+*                   -O0 is run, since the other levels move the code it writes to.
+*   ARGUMENTS   :   DIFF_HARNESS *harness, const DIFF_PROGRAM *program, unsigned long long seed
+*   RETURNS     :   VOID
+ *==============================================*/
+static void check_self_modifying(DIFF_HARNESS *harness, const DIFF_PROGRAM *program, unsigned long long seed)
+{
+    char text[DIFF_MAX_LINES * (DIFF_LABEL_SIZE + DIFF_TEXT_SIZE + 2)];
+    size_t size = render(program, text, sizeof(text));
+    unsigned char initial[TRACS_MEMORY_SIZE];
+    MACHINE_CODE code;
+    if (!assemble_text(text, size, OPTIMIZE_NONE, &code)) {
+        fail(harness, CHECK_ENGINES, seed, text, size, "does not assemble");
+        return;
+    }
+    check_engines(harness, &code, seed, text, size, initial);
+    freeMachineCode(&code);
+}
+
+/*===============================================
+*   FUNCTION    :   edit_program
+*   DESCRIPTION :   This function will make one random edit that keeps the program valid: replace, insert or delete
+*                   an instruction, or label a line that had none. Labels are never removed, ORG and EOP lines are
+*                   never touched, and new branches go to labels that exist.
+*   ARGUMENTS   :   DIFF_PROGRAM *program, unsigned long long *state, int edit
+*   RETURNS     :   VOID
+ *==============================================*/
+static void edit_program(DIFF_PROGRAM *program, unsigned long long *state, int edit)
+{
+    if (program->count < 2)
+        return;
+    int index = (int)pick(state, (unsigned int)program->count - 1);
+    DIFF_LINE *line = &program->lines[index];
+    if (strncmp(line->text, "ORG", 3) == 0)
+        return;
+
+    char text[DIFF_TEXT_SIZE];
+    int labels = 0;
+    for (int i = 0; i < program->count; i++)
+        labels += program->lines[i].label[0] != '\0';
+    if (labels > 0 && chance(state, 0.2)) {
+        int skip = (int)pick(state, (unsigned int)labels), target = 0;
+        while (program->lines[target].label[0] == '\0' || skip-- > 0)
+            target++;
+        snprintf(text, sizeof(text), "%s %s", branches[pick(state, 5)], program->lines[target].label);
+    }
+    else
+        random_instruction(program, state, text, sizeof(text));
+
+    double roll = (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+    if (line->label[0] != '\0' || roll < 0.35)
+        snprintf(line->text, sizeof(line->text), "%s", text);
+    else if (roll < 0.65 && program->count < DIFF_MAX_LINES) {
+        memmove(line + 1, line, (size_t)(program->count - index) * sizeof(DIFF_LINE));
+        program->count++;
+        set_line(line, NULL, "%s", text);
+    }
+    else if (roll < 0.9) {
+        memmove(line, line + 1, (size_t)(program->count - index - 1) * sizeof(DIFF_LINE));
+        program->count--;
+    }
+    else
+        snprintf(line->label, sizeof(line->label), "E%d", edit % 100000);
+}
+
+/*===============================================
+*   FUNCTION    :   write_text
+*   DESCRIPTION :   This function will replace the contents of a file.
+*   ARGUMENTS   :   const char *path, const char *text, size_t size
+*   RETURNS     :   bool
+ *==============================================*/
+static bool write_text(const char *path, const char *text, size_t size)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+    bool ok = fwrite(text, 1, size, file) == size;
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   same_code
+*   DESCRIPTION :   This function will compare two buffers of machine code byte for byte, addresses included.
+*   ARGUMENTS   :   const MACHINE_CODE *a, const MACHINE_CODE *b
+*   RETURNS     :   bool
+ *==============================================*/
+static bool same_code(const MACHINE_CODE *a, const MACHINE_CODE *b)
+{
+    if (a->count != b->count)
+        return false;
+    for (int i = 0; i < a->count; i++) {
+        if (a->bytes[i].address != b->bytes[i].address || a->bytes[i].value != b->bytes[i].value)
+            return false;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   check_watch
+*   DESCRIPTION :   This function will build a program the way --watch does, then edit it options->edits times and
+*                   compare every rebuild, patched or not, with a full assembly of the edited text.
+*   ARGUMENTS   :   DIFF_HARNESS *harness, DIFF_PROGRAM *program, unsigned long long seed, const char *path
+*   RETURNS     :   bool (false if the file cannot be written)
+ *==============================================*/
+static bool check_watch(DIFF_HARNESS *harness, DIFF_PROGRAM *program, unsigned long long seed, const char *path)
+{
+    char text[DIFF_MAX_LINES * (DIFF_LABEL_SIZE + DIFF_TEXT_SIZE + 2)];
+    size_t size = render(program, text, sizeof(text));
+    unsigned long long state = seed_state(~seed);
+    WATCH_FILE file;
+    bool patched;
+    if (!write_text(path, text, size))
+        return false;
+    watch_init(&file, path, OPTIMIZE_NONE);
+    watch_build(&file, &patched);
+
+    for (int edit = 0; edit < harness->options->edits; edit++) {
+        edit_program(program, &state, edit);
+        size = render(program, text, sizeof(text));
+        if (!write_text(path, text, size)) {
+            watch_free(&file);
+            return false;
+        }
+        bool built = watch_build(&file, &patched);
+        MACHINE_CODE code;
+        bool assembled = assemble_text(text, size, OPTIMIZE_NONE, &code);
+
+        harness->runs[CHECK_WATCH]++;
+        harness->patched += patched;
+        if (built != assembled)
+            fail(harness, CHECK_WATCH, seed, text, size, "edit %d: the %s build %s but a full assembly %s", edit,
+                 patched ? "patched" : "watched", built ? "succeeded" : "failed", assembled ? "succeeded" : "failed");
+        else if (built && !same_code(&file.code, &code))
+            fail(harness, CHECK_WATCH, seed, text, size, "edit %d: the %s build differs from a full assembly", edit,
+                 patched ? "patched" : "watched");
+        if (assembled)
+            freeMachineCode(&code);
+    }
+    watch_free(&file);
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   names_label
+*   DESCRIPTION :   This function will tell whether any line still has the given label as its operand.
+*   ARGUMENTS   :   const PROGRAM *program, const char *label
+*   RETURNS     :   bool
+ *==============================================*/
+static bool names_label(const PROGRAM *program, const char *label)
+{
+    for (int i = 0; i < program->line_count; i++) {
+        if (token_equals(program, program->lines[i].operand, label))
+            return true;
+    }
+    return false;
+}
+
+/*===============================================
+*   FUNCTION    :   check_seeds
+*   DESCRIPTION :   This function will check the programs behind earlier optimizer fixes. Each has an unknown
+*                   label, so it must fail at every level, and handing its lines straight to the optimizer must
+*                   not remove the line that names the label.
+*   ARGUMENTS   :   DIFF_HARNESS *harness
+*   RETURNS     :   VOID
+ *==============================================*/
+static void check_seeds(DIFF_HARNESS *harness)
+{
+    for (size_t i = 0; i < sizeof(seeds) / sizeof(seeds[0]); i++) {
+        const char *text = seeds[i].text;
+        size_t size = strlen(text);
+        harness->runs[CHECK_SEEDS]++;
+        for (int level = OPTIMIZE_NONE; level <= OPTIMIZE_MAX; level++) {
+            MACHINE_CODE code;
+            if (assemble_text(text, size, level, &code)) {
+                freeMachineCode(&code);
+                fail(harness, CHECK_SEEDS, i, text, size, "-O%d assembles a program with an unknown label", level);
+            }
+            if (level == OPTIMIZE_NONE)
+                continue;
+
+            PROGRAM program;
+            DIAGNOSTICS diagnostics;
+            diagnostics_init(&diagnostics, &heap_allocator);
+            memset(&code, 0, sizeof(code));
+            code.allocator = &heap_allocator;
+            if (process_buffer(text, size, &heap_allocator, &program, &diagnostics)) {
+                optimize_program(&program, level, &code, &diagnostics);
+                if (!names_label(&program, seeds[i].label))
+                    fail(harness, CHECK_SEEDS, i, text, size, "-O%d removes the line naming %s", level, seeds[i].label);
+                free_program(&program);
+            }
+            if (code.bytes != NULL)
+                freeMachineCode(&code);
+            diagnostics_free(&diagnostics);
+        }
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   usage
+*   DESCRIPTION :   This function will print the command-line help.
+*   ARGUMENTS   :   FILE *file, const char *program
+*   RETURNS     :   VOID
+ *==============================================*/
+static void usage(FILE *file, const char *program)
+{
+    fprintf(file,
+        "Usage: %s [options]\n"
+        "Checks -O levels, the simulator, threaded and JIT engines, and --watch patches against each other.\n"
+        "  -n COUNT    random programs to check (default: 500)\n"
+        "  -x SEED     seed of the first program; program i uses SEED + i (default: 1)\n"
+        "  -e EDITS    --watch edits per program (default: 20)\n"
+        "  -m STEPS    stop a run after STEPS instructions (default: 1000000)\n"
+        "  -d DIR      directory for the --watch file (default: .)\n"
+        "  -h          show this help\n", program);
+}
+
+/*===============================================
+*   FUNCTION    :   main
+*   DESCRIPTION :   This function will run every check and print how many runs of each failed.
+*   ARGUMENTS   :   int argc, char *argv[]
+*   RETURNS     :   int (0 if every check passed)
+ *==============================================*/
+int main(int argc, char *argv[])
+{
+    DIFF_OPTIONS options = { 1, 500, 20, SIM_DEFAULT_STEP_LIMIT, "." };
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0)
+        {
+            usage(stdout, argv[0]);
+            return 0;
+        }
+        if (arg[0] != '-' || strchr("nxemd", arg[1]) == NULL || arg[1] == '\0' || arg[2] != '\0' || i + 1 == argc)
+        {
+            usage(stderr, argv[0]);
+            return 2;
+        }
+        const char *value = argv[++i];
+        char *end;
+        bool valid = true;
+        switch (arg[1])
+        {
+        case 'n': options.programs = strtol(value, &end, 10); valid = *end == '\0' && options.programs >= 0; break;
+        case 'x': options.seed = strtoull(value, &end, 0); valid = *end == '\0'; break;
+        case 'e': options.edits = (int)strtol(value, &end, 10); valid = *end == '\0' && options.edits >= 0; break;
+        case 'm': options.step_limit = strtoull(value, &end, 0); valid = *end == '\0' && options.step_limit > 0; break;
+        case 'd': options.directory = value; break;
+        }
+        if (!valid)
+        {
+            fprintf(stderr, "Invalid value for %s: %s\n", arg, value);
+            return 2;
+        }
+    }
+
+    DIFF_HARNESS harness = { &options, { 0 }, { 0 }, 0, 0, NULL, NULL, NULL };
+    DIFF_PROGRAM *program = malloc(sizeof(DIFF_PROGRAM));
+    char *path = malloc(strlen(options.directory) + sizeof("/" DIFF_WATCH_FILE));
+    harness.threaded = malloc(sizeof(THREADED_CODE));
+    harness.machines = malloc(4 * sizeof(MACHINE));
+    harness.jit = malloc(sizeof(JIT));
+    if (program == NULL || path == NULL || harness.threaded == NULL || harness.machines == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    if (harness.jit != NULL && !jit_init(harness.jit))
+    {
+        free(harness.jit);
+        harness.jit = NULL;
+    }
+    sprintf(path, "%s/" DIFF_WATCH_FILE, options.directory);
+
+    bool written = true;
+    for (long i = 0; i < options.programs && written; i++)
+    {
+        unsigned long long seed = options.seed + (unsigned long long)i;
+        generate_program(program, seed, false);
+        check_levels(&harness, program, seed);
+        written = check_watch(&harness, program, seed, path);
+        generate_program(program, seed, true);
+        check_self_modifying(&harness, program, seed);
+    }
+    remove(path);
+    if (!written)
+        fprintf(stderr, "Error writing %s\n", path);
+    check_seeds(&harness);
+
+    long failures = 0;
+    for (int check = 0; check < CHECK_COUNT; check++)
+    {
+        printf("%-8s %8ld runs %8ld failed", checkNames[check], harness.runs[check], harness.failures[check]);
+        if (check == CHECK_ENGINES)
+            printf("  (%s)", harness.jit != NULL ? "simulator, threaded and JIT" : "simulator and threaded; no JIT here");
+        if (check == CHECK_WATCH)
+            printf("  (%ld patched)", harness.patched);
+        printf("\n");
+        failures += harness.failures[check];
+    }
+
+    if (harness.jit != NULL)
+        jit_free(harness.jit);
+    free(harness.jit);
+    free(harness.machines);
+    free(harness.threaded);
+    free(program);
+    free(path);
+    return failures == 0 && written ? 0 : 1;
+}
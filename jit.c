@@ -0,0 +1,522 @@
+/*======================================================================================================
+* FILE        : jit.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the x86-64 JIT of the simulator. Basic blocks are compiled to native code
+*               the first time they are reached, into a buffer that is writable while compiling and only
+*               executable while running. Blocks jump to each other through the entry table without
+*               returning to C; ACC, MBR and IOB stay in BL, R12B and R13B, and the flags are stored only
+*               by the last instruction that sets them before the block can exit.
+*
+*               Register use in the generated code: R14 = MACHINE, R15 = JIT_CONTEXT, RBP = remaining
+*               steps, EAX = PC on an exit or an indirect jump, EDX = exit reason.
+*
+*               A block checks the step budget once on entry; if fewer steps are left than it needs it
+*               returns, and jit_run() finishes with sim_run() so the limit is exact. A WM to a byte that
+*               belongs to a compiled block returns as well, and the whole cache is dropped and rebuilt
+*               from the new memory. Each run first checks that the bytes the blocks were compiled from are
+*               unchanged, so one JIT can be reused across runs and across changes to memory between runs.
+*               It gives the same results as sim_run().
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <string.h>
+#include <limits.h>
+#include "opcodes.h"
+#include "jit.h"
+
+#if JIT_SUPPORTED
+#include <sys/mman.h>
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+typedef enum jitExit {
+    JIT_EXIT_MISS,          // Reached a block that is not compiled yet
+    JIT_EXIT_BUDGET,        // Not enough steps left for the next block
+    JIT_EXIT_MODIFIED,      // WM wrote into compiled code
+    JIT_EXIT_HALTED,
+    JIT_EXIT_INVALID_OPCODE,
+    JIT_EXIT_PC_OUT_OF_RANGE
+} JIT_EXIT;
+
+typedef int (*JIT_ENTRY)(JIT_CONTEXT *context, MACHINE *machine, unsigned int pc);
+
+typedef struct jitInsn {
+    unsigned int address;
+    unsigned char opcode;
+    unsigned int operand;
+    bool storeFlags;
+} JIT_INSN;
+
+#define CONTEXT_OFFSET(field)   ((unsigned int)offsetof(JIT_CONTEXT, field))
+#define MACHINE_OFFSET(field)   ((unsigned int)offsetof(MACHINE, field))
+#define ENTRY_OFFSET(pc)        (CONTEXT_OFFSET(entry) + (unsigned int)(pc) * (unsigned int)sizeof(void *))
+#define EXIT_STUB_SIZE          15      // mov eax, pc; mov edx, reason; jmp exit
+#define MAX_INSN_SIZE           64      // Longest native sequence for one instruction
+#define MAX_BLOCK_SIZE          (32 + JIT_BLOCK_LIMIT * MAX_INSN_SIZE)
+
+/*===============================================
+*   FUNCTION    :   emit
+*   DESCRIPTION :   This function will append bytes to the code buffer.
+*   ARGUMENTS   :   JIT *jit, const unsigned char *bytes, size_t count
+*   RETURNS     :   VOID
+ *==============================================*/
+static void emit(JIT *jit, const unsigned char *bytes, size_t count)
+{
+    memcpy(jit->buffer + jit->used, bytes, count);
+    jit->used += count;
+}
+
+#define EMIT(...) do { \
+        const unsigned char bytes_[] = { __VA_ARGS__ }; \
+        emit(jit, bytes_, sizeof(bytes_)); \
+    } while (0)
+
+/*===============================================
+*   FUNCTION    :   emit32
+*   DESCRIPTION :   This function will append a little-endian 32-bit value.
+*   ARGUMENTS   :   JIT *jit, unsigned int value
+*   RETURNS     :   VOID
+ *==============================================*/
+static void emit32(JIT *jit, unsigned int value)
+{
+    EMIT(value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24);
+}
+
+/*===============================================
+*   FUNCTION    :   emit_exit
+*   DESCRIPTION :   This function will emit a return to jit_run() with the given PC and reason.
+*   ARGUMENTS   :   JIT *jit, unsigned int pc, JIT_EXIT reason
+*   RETURNS     :   VOID
+ *==============================================*/
+static void emit_exit(JIT *jit, unsigned int pc, JIT_EXIT reason)
+{
+    EMIT(0xB8); emit32(jit, pc);                        // mov eax, pc
+    EMIT(0xBA); emit32(jit, reason);                    // mov edx, reason
+    EMIT(0xE9); emit32(jit, (unsigned int)(0 - (jit->used + 4)));   // jmp exit (at offset 0)
+}
+
+/*===============================================
+*   FUNCTION    :   emit_jump
+*   DESCRIPTION :   This function will emit a jump to the block at pc through the entry table.
+*   ARGUMENTS   :   JIT *jit, unsigned int pc
+*   RETURNS     :   VOID
+ *==============================================*/
+static void emit_jump(JIT *jit, unsigned int pc)
+{
+    EMIT(0xB8); emit32(jit, pc);                        // mov eax, pc
+    EMIT(0x41, 0xFF, 0xA7); emit32(jit, ENTRY_OFFSET(pc));  // jmp [r15 + entry[pc]]
+}
+
+/*===============================================
+*   FUNCTION    :   emit_store_flags
+*   DESCRIPTION :   This function will store the host flags of the last ALU instruction as TRACS flags.
+*   ARGUMENTS   :   JIT *jit, bool overflow (false stores OVERFLOW as clear instead of from the host)
+*   RETURNS     :   VOID
+ *==============================================*/
+static void emit_store_flags(JIT *jit, bool overflow)
+{
+    EMIT(0x41, 0x0F, 0x94, 0x87); emit32(jit, CONTEXT_OFFSET(zero));    // sete [r15 + zero]
+    EMIT(0x41, 0x0F, 0x92, 0x87); emit32(jit, CONTEXT_OFFSET(carry));   // setb [r15 + carry]
+    EMIT(0x41, 0x0F, 0x98, 0x87); emit32(jit, CONTEXT_OFFSET(sign));    // sets [r15 + sign]
+    if (overflow) {
+        EMIT(0x41, 0x0F, 0x90, 0x87); emit32(jit, CONTEXT_OFFSET(overflow));    // seto [r15 + overflow]
+    } else {
+        EMIT(0x41, 0xC6, 0x87); emit32(jit, CONTEXT_OFFSET(overflow)); EMIT(0x00);  // mov byte [r15 + overflow], 0
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   emit_stubs
+*   DESCRIPTION :   This function will emit the shared exit code, the compile-miss stub and the entry code at
+*                   the start of the buffer. The exit code must be at offset 0.
+*   ARGUMENTS   :   JIT *jit
+*   RETURNS     :   VOID
+ *==============================================*/
+static void emit_stubs(JIT *jit)
+{
+    jit->used = 0;
+
+    // Exit: write the registers back and return the reason
+    EMIT(0x41, 0x88, 0x9E); emit32(jit, MACHINE_OFFSET(acc));      // mov [r14 + acc], bl
+    EMIT(0x45, 0x88, 0xA6); emit32(jit, MACHINE_OFFSET(mbr));      // mov [r14 + mbr], r12b
+    EMIT(0x45, 0x88, 0xAE); emit32(jit, MACHINE_OFFSET(iob));      // mov [r14 + iob], r13b
+    EMIT(0x49, 0x89, 0xAF); emit32(jit, CONTEXT_OFFSET(budget));   // mov [r15 + budget], rbp
+    EMIT(0x41, 0x89, 0x87); emit32(jit, CONTEXT_OFFSET(pc));       // mov [r15 + pc], eax
+    EMIT(0x89, 0xD0);                                               // mov eax, edx
+    EMIT(0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B, 0xC3);   // pop r15 ... rbx; ret
+
+    // Miss: EAX already holds the PC
+    jit->miss_stub = jit->used;
+    EMIT(0xBA); emit32(jit, JIT_EXIT_MISS);                        // mov edx, JIT_EXIT_MISS
+    EMIT(0xE9); emit32(jit, (unsigned int)(0 - (jit->used + 4)));  // jmp exit
+
+    // Entry: int entry(JIT_CONTEXT *rdi, MACHINE *rsi, unsigned int edx)
+    jit->entry_stub = jit->used;
+    EMIT(0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57);   // push rbx ... r15
+    EMIT(0x49, 0x89, 0xFF);                                         // mov r15, rdi
+    EMIT(0x49, 0x89, 0xF6);                                         // mov r14, rsi
+    EMIT(0x41, 0x0F, 0xB6, 0x9E); emit32(jit, MACHINE_OFFSET(acc));    // movzx ebx, byte [r14 + acc]
+    EMIT(0x45, 0x0F, 0xB6, 0xA6); emit32(jit, MACHINE_OFFSET(mbr));    // movzx r12d, byte [r14 + mbr]
+    EMIT(0x45, 0x0F, 0xB6, 0xAE); emit32(jit, MACHINE_OFFSET(iob));    // movzx r13d, byte [r14 + iob]
+    EMIT(0x49, 0x8B, 0xAF); emit32(jit, CONTEXT_OFFSET(budget));   // mov rbp, [r15 + budget]
+    EMIT(0x89, 0xD0);                                               // mov eax, edx
+    EMIT(0x41, 0xFF, 0xA4, 0xC7); emit32(jit, CONTEXT_OFFSET(entry));  // jmp [r15 + rax * 8 + entry]
+    jit->stubs = jit->used;
+}
+
+/*===============================================
+*   FUNCTION    :   set_protection
+*   DESCRIPTION :   This function will make the code buffer writable for compiling or executable for running.
+*   ARGUMENTS   :   JIT *jit, bool writable
+*   RETURNS     :   bool
+ *==============================================*/
+static bool set_protection(JIT *jit, bool writable)
+{
+    if (jit->writable == writable)
+        return true;
+    if (mprotect(jit->buffer, JIT_BUFFER_SIZE, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) != 0)
+        return false;
+    jit->writable = writable;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   sets_flags
+*   DESCRIPTION :   This function will tell if an opcode overwrites the flags.
+*   ARGUMENTS   :   unsigned char opcode
+*   RETURNS     :   bool
+ *==============================================*/
+static bool sets_flags(unsigned char opcode)
+{
+    switch (opcode) {
+    case OP_ADD: case OP_SUB: case OP_MUL: case OP_AND: case OP_OR: case OP_XOR: case OP_NOT: case OP_SHL: case OP_SHR:
+    case OP_BRE: case OP_BRNE: case OP_BRGT: case OP_BRLT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   is_valid
+*   DESCRIPTION :   This function will tell if an opcode is part of the instruction set.
+*   ARGUMENTS   :   unsigned char opcode
+*   RETURNS     :   bool
+ *==============================================*/
+static bool is_valid(unsigned char opcode)
+{
+    switch (opcode) {
+#define X(name, a, b, c, d, opcode, kind) case OP_##name:
+    TRACS_MNEMONICS(X)
+#undef X
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   mark_compiled
+*   DESCRIPTION :   This function will record that a byte of memory is part of a compiled block.
+*   ARGUMENTS   :   JIT *jit, const MACHINE *machine, unsigned int address
+*   RETURNS     :   VOID
+ *==============================================*/
+static void mark_compiled(JIT *jit, const MACHINE *machine, unsigned int address)
+{
+    if (address >= TRACS_MEMORY_SIZE || jit->context.compiled[address])
+        return;
+    jit->context.compiled[address] = 1;
+    jit->image[address] = machine->memory[address];
+    jit->sources[jit->source_count++] = (unsigned short)address;
+}
+
+/*===============================================
+*   FUNCTION    :   compile_block
+*   DESCRIPTION :   This function will compile the basic block that starts at start and point its entry at it.
+*   ARGUMENTS   :   JIT *jit, const MACHINE *machine, unsigned int start
+*   RETURNS     :   bool (false if the buffer is full)
+ *==============================================*/
+static bool compile_block(JIT *jit, const MACHINE *machine, unsigned int start)
+{
+    if (jit->used + MAX_BLOCK_SIZE > JIT_BUFFER_SIZE)
+        return false;
+
+    // Decode up to a branch, EOP, a fault or the size limit
+    JIT_INSN insns[JIT_BLOCK_LIMIT];
+    unsigned int count = 0;
+    unsigned int address = start;
+    JIT_EXIT fault = JIT_EXIT_MISS;     // MISS here means the block ends without a fault
+    bool terminated = false;
+    while (count < JIT_BLOCK_LIMIT && !terminated) {
+        if (address + 1 >= TRACS_MEMORY_SIZE) {
+            fault = JIT_EXIT_PC_OUT_OF_RANGE;
+            break;
+        }
+        unsigned char high = machine->memory[address];
+        unsigned char opcode = high & OPCODE_MASK;
+        if (!is_valid(opcode)) {
+            fault = JIT_EXIT_INVALID_OPCODE;
+            break;
+        }
+        insns[count].address = address;
+        insns[count].opcode = opcode;
+        insns[count].operand = ((high & 0x07) << 8) | machine->memory[address + 1];
+        insns[count].storeFlags = false;
+        count++;
+        address += 2;
+        terminated = opcode == OP_BR || opcode == OP_BRE || opcode == OP_BRNE || opcode == OP_BRGT ||
+                     opcode == OP_BRLT || opcode == OP_EOP;
+    }
+
+    // Only the last flag-setting instruction before each exit (a WM or the end of the block) stores them
+    bool pending = true;
+    for (unsigned int i = count; i-- > 0;) {
+        if (insns[i].opcode == OP_WM)
+            pending = true;
+        else if (pending && sets_flags(insns[i].opcode)) {
+            insns[i].storeFlags = true;
+            pending = false;
+        }
+    }
+
+    if (!set_protection(jit, true))
+        return false;
+    jit->context.entry[start] = jit->buffer + jit->used;
+
+    // A block that ends in a fault needs one more step left, so the step limit wins over the fault
+    unsigned int needed = count + (fault != JIT_EXIT_MISS ? 1 : 0);
+    EMIT(0x48, 0x81, 0xFD); emit32(jit, needed);                    // cmp rbp, needed
+    EMIT(0x73, EXIT_STUB_SIZE);                                     // jae over the exit
+    emit_exit(jit, start, JIT_EXIT_BUDGET);
+    if (count > 0) {
+        EMIT(0x48, 0x81, 0xED); emit32(jit, count);                 // sub rbp, count
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        const JIT_INSN *insn = &insns[i];
+        unsigned int operand = insn->operand;
+        unsigned int next = insn->address + 2;
+        mark_compiled(jit, machine, insn->address);
+        mark_compiled(jit, machine, insn->address + 1);
+
+        switch (insn->opcode) {
+        case OP_WB:   EMIT(0x41, 0xB4, operand & 0xFF); break;                             // mov r12b, imm
+        case OP_WIB:  EMIT(0x41, 0xB5, operand & 0xFF); break;                             // mov r13b, imm
+        case OP_RM:   EMIT(0x45, 0x8A, 0xA6); emit32(jit, MACHINE_OFFSET(memory) + operand); break;   // mov r12b, [r14 + memory + n]
+        case OP_WIO:  EMIT(0x45, 0x88, 0xAE); emit32(jit, MACHINE_OFFSET(io) + operand); break;       // mov [r14 + io + n], r13b
+        case OP_WACC: EMIT(0x44, 0x88, 0xE3); break;                                       // mov bl, r12b
+        case OP_RACC: EMIT(0x41, 0x88, 0xDC); break;                                       // mov r12b, bl
+        case OP_SWAP: EMIT(0x45, 0x86, 0xEC); break;                                       // xchg r12b, r13b
+        case OP_ADD:  EMIT(0x44, 0x00, 0xE3); break;                                       // add bl, r12b
+        case OP_SUB:  EMIT(0x44, 0x28, 0xE3); break;                                       // sub bl, r12b
+        case OP_AND:  EMIT(0x44, 0x20, 0xE3); break;                                       // and bl, r12b
+        case OP_OR:   EMIT(0x44, 0x08, 0xE3); break;                                       // or bl, r12b
+        case OP_XOR:  EMIT(0x44, 0x30, 0xE3); break;                                       // xor bl, r12b
+        case OP_NOT:  EMIT(0x80, 0xF3, 0xFF); break;                                       // xor bl, 0xff
+        case OP_SHL:  EMIT(0xD0, 0xE3); break;                                             // shl bl, 1
+        case OP_SHR:  EMIT(0xD0, 0xEB); break;                                             // shr bl, 1
+        case OP_MUL:
+            EMIT(0x88, 0xD8, 0x41, 0xF6, 0xE4, 0x88, 0xC3);                                // mov al, bl; mul r12b; mov bl, al
+            if (insn->storeFlags) {
+                // MUL leaves only CARRY defined; take ZERO and SIGN from the low byte
+                EMIT(0x41, 0x0F, 0x92, 0x87); emit32(jit, CONTEXT_OFFSET(carry));         // setb [r15 + carry]
+                EMIT(0x84, 0xDB);                                                          // test bl, bl
+                EMIT(0x41, 0x0F, 0x94, 0x87); emit32(jit, CONTEXT_OFFSET(zero));          // sete [r15 + zero]
+                EMIT(0x41, 0x0F, 0x98, 0x87); emit32(jit, CONTEXT_OFFSET(sign));          // sets [r15 + sign]
+                EMIT(0x41, 0xC6, 0x87); emit32(jit, CONTEXT_OFFSET(overflow)); EMIT(0x00); // mov byte [r15 + overflow], 0
+            }
+            break;
+        case OP_WM: {
+            EMIT(0x45, 0x88, 0xA6); emit32(jit, MACHINE_OFFSET(memory) + operand);         // mov [r14 + memory + n], r12b
+            EMIT(0x41, 0x80, 0xBF); emit32(jit, CONTEXT_OFFSET(compiled) + operand); EMIT(0x00);   // cmp byte [r15 + compiled + n], 0
+            unsigned int refund = count - i - 1;
+            EMIT(0x74, EXIT_STUB_SIZE + (refund > 0 ? 7 : 0));                             // je over the exit
+            if (refund > 0) {
+                EMIT(0x48, 0x81, 0xC5); emit32(jit, refund);                               // add rbp, refund
+            }
+            emit_exit(jit, next, JIT_EXIT_MODIFIED);
+            break;
+        }
+        case OP_BR:
+            emit_jump(jit, operand);
+            break;
+        case OP_BRE: case OP_BRNE: case OP_BRGT: case OP_BRLT: {
+            EMIT(0x44, 0x38, 0xE3);                                                        // cmp bl, r12b
+            emit_store_flags(jit, true);
+            unsigned char condition = insn->opcode == OP_BRE ? 0x84 : insn->opcode == OP_BRNE ? 0x85 :
+                                      insn->opcode == OP_BRGT ? 0x87 : 0x82;                // je, jne, ja, jb
+            EMIT(0x0F, condition); emit32(jit, 12);                                        // jcc over the fall-through
+            emit_jump(jit, next);
+            emit_jump(jit, operand);
+            break;
+        }
+        case OP_EOP:
+            emit_exit(jit, next, JIT_EXIT_HALTED);
+            break;
+        }
+
+        if (insn->storeFlags && insn->opcode != OP_MUL && insn->opcode != OP_BRE && insn->opcode != OP_BRNE &&
+            insn->opcode != OP_BRGT && insn->opcode != OP_BRLT)
+            emit_store_flags(jit, insn->opcode != OP_SHL && insn->opcode != OP_SHR);
+    }
+
+    if (fault != JIT_EXIT_MISS) {
+        mark_compiled(jit, machine, address);
+        mark_compiled(jit, machine, address + 1);
+        emit_exit(jit, address, fault);
+    } else if (!terminated) {
+        emit_jump(jit, address);
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   jit_init
+*   DESCRIPTION :   This function will map the code buffer and emit the stubs.
+*   ARGUMENTS   :   JIT *jit
+*   RETURNS     :   bool (false if the host cannot run generated code)
+ *==============================================*/
+bool jit_init(JIT *jit)
+{
+    jit->buffer = mmap(NULL, JIT_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (jit->buffer == MAP_FAILED) {
+        jit->buffer = NULL;
+        return false;
+    }
+    jit->writable = true;
+    emit_stubs(jit);
+    jit_flush(jit);
+    if (!set_protection(jit, false)) {
+        jit_free(jit);
+        return false;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   jit_free
+*   DESCRIPTION :   This function will unmap the code buffer.
+*   ARGUMENTS   :   JIT *jit
+*   RETURNS     :   VOID
+ *==============================================*/
+void jit_free(JIT *jit)
+{
+    if (jit->buffer != NULL)
+        munmap(jit->buffer, JIT_BUFFER_SIZE);
+    jit->buffer = NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   jit_flush
+*   DESCRIPTION :   This function will drop every compiled block.
+*   ARGUMENTS   :   JIT *jit
+*   RETURNS     :   VOID
+ *==============================================*/
+void jit_flush(JIT *jit)
+{
+    const void *miss = jit->buffer + jit->miss_stub;
+    for (unsigned int pc = 0; pc <= TRACS_MEMORY_SIZE; pc++)
+        jit->context.entry[pc] = miss;
+    memset(jit->context.compiled, 0, sizeof(jit->context.compiled));
+    jit->source_count = 0;
+    jit->used = jit->stubs;
+}
+
+/*===============================================
+*   FUNCTION    :   jit_run
+*   DESCRIPTION :   This function will run the machine until EOP, a fault, or step_limit instructions (0 for no
+*                   limit), exactly like sim_run().
+*   ARGUMENTS   :   JIT *jit, MACHINE *machine, unsigned long long step_limit
+*   RETURNS     :   SIM_STATUS
+ *==============================================*/
+SIM_STATUS jit_run(JIT *jit, MACHINE *machine, unsigned long long step_limit)
+{
+    if (machine->status != SIM_RUNNING)
+        return machine->status;
+    if (machine->pc + 1 >= TRACS_MEMORY_SIZE)
+        return machine->status = SIM_PC_OUT_OF_RANGE;
+    for (unsigned int i = 0; i < jit->source_count; i++) {
+        unsigned int address = jit->sources[i];
+        if (machine->memory[address] != jit->image[address]) {
+            jit_flush(jit);
+            break;
+        }
+    }
+
+    JIT_CONTEXT *context = &jit->context;
+    unsigned long long budget = step_limit == 0 ? ULLONG_MAX : step_limit > machine->steps ? step_limit - machine->steps : 1;
+    context->budget = budget;
+    context->zero = (machine->flags & FLAG_ZERO) != 0;
+    context->carry = (machine->flags & FLAG_CARRY) != 0;
+    context->sign = (machine->flags & FLAG_SIGN) != 0;
+    context->overflow = (machine->flags & FLAG_OVERFLOW) != 0;
+
+    JIT_ENTRY entry = (JIT_ENTRY)(void *)(jit->buffer + jit->entry_stub);
+    unsigned int pc = machine->pc;
+    int reason;
+    for (;;) {
+        if (!set_protection(jit, false))
+            return sim_run(machine, step_limit);
+        reason = entry(context, machine, pc);
+        pc = context->pc;
+        if (reason == JIT_EXIT_MISS) {
+            if (!compile_block(jit, machine, pc)) {
+                jit_flush(jit);
+                compile_block(jit, machine, pc);
+            }
+        } else if (reason == JIT_EXIT_MODIFIED) {
+            jit_flush(jit);
+        } else {
+            break;
+        }
+    }
+
+    machine->pc = pc;
+    machine->steps += budget - context->budget;
+    machine->flags = (context->zero ? FLAG_ZERO : 0) | (context->carry ? FLAG_CARRY : 0) |
+                     (context->sign ? FLAG_SIGN : 0) | (context->overflow ? FLAG_OVERFLOW : 0);
+    switch (reason) {
+    case JIT_EXIT_HALTED:           return machine->status = SIM_HALTED;
+    case JIT_EXIT_INVALID_OPCODE:   return machine->status = SIM_INVALID_OPCODE;
+    case JIT_EXIT_PC_OUT_OF_RANGE:  return machine->status = SIM_PC_OUT_OF_RANGE;
+    default:
+        // Fewer steps left than the next block needs: finish one instruction at a time
+        if (context->budget == 0)
+            return machine->status = SIM_STEP_LIMIT;
+        return sim_run(machine, step_limit);
+    }
+}
+
+#else
+
+bool jit_init(JIT *jit)
+{
+    jit->buffer = NULL;
+    return false;
+}
+
+void jit_free(JIT *jit)
+{
+    (void)jit;
+}
+
+void jit_flush(JIT *jit)
+{
+    (void)jit;
+}
+
+SIM_STATUS jit_run(JIT *jit, MACHINE *machine, unsigned long long step_limit)
+{
+    (void)jit;
+    return sim_run(machine, step_limit);
+}
+
+#endif
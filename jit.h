@@ -0,0 +1,52 @@
+#ifndef JIT_H
+#define JIT_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stddef.h>
+#include <stdbool.h>
+#include "simulator.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define JIT_SUPPORTED 1
+#else
+#define JIT_SUPPORTED 0
+#endif
+
+#define JIT_BUFFER_SIZE (256 * 1024)   // Native code cache, flushed when full
+#define JIT_BLOCK_LIMIT 64              // Most instructions compiled into one basic block
+
+/*
+ * State shared with the generated code, which addresses every field relative to one register. The entry
+ * table holds the native address of each compiled block, or of a stub that asks for it to be compiled.
+ */
+typedef struct jit_context {
+    const void *entry[TRACS_MEMORY_SIZE + 1];
+    unsigned long long budget;                  // Instructions left before the step limit
+    unsigned int pc;                            // PC when the generated code returned
+    unsigned char zero, carry, sign, overflow;  // Flags, one byte each so setcc can store them
+    unsigned char compiled[TRACS_MEMORY_SIZE];  // Nonzero for every byte that is part of a compiled block
+} JIT_CONTEXT;
+
+typedef struct jit {
+    JIT_CONTEXT context;
+    unsigned char *buffer;      // JIT_BUFFER_SIZE bytes, either writable or executable, never both
+    size_t used;
+    size_t miss_stub;           // Offset of the stub that asks for a block to be compiled
+    size_t entry_stub;          // Offset of the code called from C; the exit code is at offset 0
+    size_t stubs;               // Size of the stubs at the start of the buffer
+    bool writable;
+    unsigned char image[TRACS_MEMORY_SIZE];     // Memory the blocks were compiled from
+    unsigned short sources[TRACS_MEMORY_SIZE];  // Addresses of those bytes, checked before every run
+    unsigned int source_count;
+} JIT;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+bool jit_init(JIT *jit);
+void jit_free(JIT *jit);
+void jit_flush(JIT *jit);
+SIM_STATUS jit_run(JIT *jit, MACHINE *machine, unsigned long long step_limit);
+
+#endif
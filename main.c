@@ -4,52 +4,739 @@
 *               Ben Cesar Cadungog (Software Lead)
 *               Jeddah Laine Lucenara  (Research Lead)
 *               Harold Marvin Comendador (Documentation Lead)
-* DESCRIPTION : This file contains the main function that assembles the assembly code and interprets the translation.txt file.
+* DESCRIPTION : This file contains the command-line driver of the assembler.
 * COPYRIGHT   : 24 April, 2024
 * REVISION HISTORY:
 *   24 April, 2024: V1.0 - File Created, made main function to assemble and interpret translation.txt file.
+*   16 October, 2026: V1.1 - Machine code is taken from assemble() directly instead of re-reading translation.txt.
+*   16 October, 2026: V1.2 - Also writes the binary memory image and Intel HEX file.
+*   16 October, 2026: V1.3 - Command-line options for input/output paths, output format, quiet mode and stdin/stdout.
+*   16 October, 2026: V1.4 - Batch mode assembles many inputs in parallel on the work-stealing pool.
+*   16 October, 2026: V1.5 - -r runs the assembled program on the built-in simulator.
+*   16 October, 2026: V1.6 - -r uses the threaded execution engine.
+*   16 October, 2026: V1.7 - -r uses the x86-64 JIT where available.
+*   16 October, 2026: V1.8 - -s/-w sweep the program over many input vectors on every core.
+*   16 October, 2026: V1.9 - --stats reports per-phase time, throughput and memory as text or JSON.
+*   16 October, 2026: V2.0 - --trace writes per-phase, per-input and per-thread spans as Chrome trace JSON.
+*   16 October, 2026: V2.1 - Every pool worker assembles out of its own arena, reset after each input.
+*   16 October, 2026: V2.2 - --cache serves unchanged inputs from an on-disk assembly cache.
+*   16 October, 2026: V2.3 - --watch reassembles the inputs whenever they are saved, patching edits in.
+*   16 October, 2026: V2.4 - -O runs the peephole optimizer before encoding.
+*   16 October, 2026: V2.5 - -O2 adds the data-flow pass.
+*   16 October, 2026: V2.6 - -O3 adds constant folding.
+*   16 October, 2026: V2.7 - The results of -r are printed under the stdout lock, one input at a time.
+*   16 October, 2026: V2.8 - The job context of a batch is JOB_BATCH, so it cannot clash with BATCH in batch.h.
+*   16 October, 2026: V2.9 - -O only optimizes a program that assembles without errors.
+*   16 October, 2026: V3.0 - A bin or hex image that does not fit is reported before its file is created.
 ======================================================================================================*/
 /*===============================================
  *   HEADER FILES
  *==============================================*/
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include "assembler.h"
 #include "translation.h"
+#include "pool.h"
+#include "simulator.h"
+#include "threaded.h"
+#include "jit.h"
+#include "sweep.h"
+#include "trace.h"
+#include "arena.h"
+#include "cache.h"
+#include "watch.h"
+#include "optimizer.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define DEFAULT_INPUT "script.asm"
+
+typedef enum statsFormat {
+    STATS_NONE,
+    STATS_TEXT,
+    STATS_JSON
+} STATS_FORMAT;
+
+typedef struct outputFormat {
+    const char *name;
+    const char *extension;
+    const char *mode;
+    bool image;                     // Writes a memory image, so the code must fit in the address space
+    bool (*writer)(const MACHINE_CODE *code, FILE *file);
+} OUTPUT_FORMAT;
+
+typedef struct options {
+    const char **inputs;
+    int input_count;
+    const char *output;             // NULL derives the name from the input, "-" is stdout
+    const OUTPUT_FORMAT *format;
+    bool formatGiven;
+    bool quiet;
+    int jobs;                       // Worker threads for batch mode, 0 for one per core
+    bool run;                       // Run the program on the simulator after assembling it
+    unsigned long long step_limit;
+    bool sweeping;                  // -s was given: run once per input vector instead of once
+    SWEEP sweep;
+    STATS_FORMAT stats;
+    const char *trace;              // Chrome trace-event file, NULL for none
+    const char *cache;              // Assembly cache directory, NULL for none
+    bool watch;                     // Keep reassembling the inputs whenever they change
+    int optimize;                   // -O level, OPTIMIZE_NONE unless asked for
+} OPTIONS;
+
+typedef struct jobBatch {
+    const OPTIONS *options;
+    bool *succeeded;                // One slot per input, written only by the job that owns it
+    STATS *stats;                   // Likewise, NULL without --stats or --trace
+    ARENA *arenas;                  // One per pool worker, reset after every input
+} JOB_BATCH;
+
+static bool write_c(const MACHINE_CODE *code, FILE *file);
+
+static const OUTPUT_FORMAT formats[] = {
+    { "txt", ".txt", "w",  false, writeTranslation },
+    { "bin", ".bin", "wb", true,  writeBinaryImage },
+    { "hex", ".hex", "w",  true,  writeIntelHex },
+    { "c",   ".c",   "w",  false, write_c },
+};
 
 /*===============================================
- *   FUNCTION PROTOTYPES
+*   FUNCTION    :   write_c
+*   DESCRIPTION :   This function will write the TRACS "C" MainMemory() statements.
+*   ARGUMENTS   :   const MACHINE_CODE *code, FILE *file
+*   RETURNS     :   bool
  *==============================================*/
-int main()
+static bool write_c(const MACHINE_CODE *code, FILE *file)
 {
-    // Making a messageArray of strings
-    if(assemble())
+    printMainMemory(code, file);
+    return !ferror(file);
+}
+
+/*===============================================
+*   FUNCTION    :   write_output
+*   DESCRIPTION :   This function will write the machine code to a file ("-" for stdout) with one of the
+*                   translation.c writers. An image that does not fit is reported before the file is opened,
+*                   so an existing file is left as it was.
+*   ARGUMENTS   :   const char *input, const char *filename, const OUTPUT_FORMAT *format, const MACHINE_CODE *code
+*   RETURNS     :   bool
+ *==============================================*/
+static bool write_output(const char *input, const char *filename, const OUTPUT_FORMAT *format, const MACHINE_CODE *code)
+{
+    unsigned char image[TRACS_MEMORY_SIZE];
+    if (format->image && !buildMemoryImage(code, image, NULL))
     {
-        printf("Assembly successful!\n");
-        int line_count;
-        MACHINE_CODE_LINE* array = interpretTranslation("translation.txt", &line_count);
-        if (array == NULL)
+        fprintf(stderr, "%s: program does not fit in the 11-bit address space\n", input);
+        return false;
+    }
+
+    if (strcmp(filename, "-") == 0)
+    {
+#ifdef _WIN32
+        if (strchr(format->mode, 'b') != NULL)
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        bool ok = format->writer(code, stdout) && fflush(stdout) == 0;
+        if (!ok)
+            fprintf(stderr, "Error writing standard output\n");
+        return ok;
+    }
+
+    FILE *file = fopen(filename, format->mode);
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening %s\n", filename);
+        return false;
+    }
+    bool ok = format->writer(code, file);
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        fprintf(stderr, "Error writing %s\n", filename);
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   output_name
+*   DESCRIPTION :   This function will derive the output path from the input path by swapping the extension.
+*   ARGUMENTS   :   const char *input, const OUTPUT_FORMAT *format
+*   RETURNS     :   char * (caller frees)
+ *==============================================*/
+static char *output_name(const char *input, const OUTPUT_FORMAT *format)
+{
+    size_t length = strlen(input);
+    const char *dot = strrchr(input, '.');
+    const char *slash = strrchr(input, '/');
+    const char *backslash = strrchr(input, '\\');
+    if (backslash > slash)
+        slash = backslash;
+    if (dot != NULL && (slash == NULL || dot > slash))
+        length = dot - input;
+
+    char *name = malloc(length + strlen(format->extension) + 1);
+    if (name == NULL)
+        return NULL;
+    memcpy(name, input, length);
+    strcpy(name + length, format->extension);
+    return name;
+}
+
+/*===============================================
+*   FUNCTION    :   run_program
+*   DESCRIPTION :   This function will run the machine code on the simulator and print the final state.
+*   ARGUMENTS   :   const char *input, const MACHINE_CODE *code, const OPTIONS *options
+*   RETURNS     :   bool (true if the program reached EOP)
+ *==============================================*/
+static bool run_program(const char *input, const MACHINE_CODE *code, const OPTIONS *options)
+{
+    MACHINE *machine = malloc(sizeof(MACHINE));
+    THREADED_CODE *threaded = malloc(sizeof(THREADED_CODE));
+    unsigned char *initial = malloc(TRACS_MEMORY_SIZE);
+    if (machine == NULL || threaded == NULL || initial == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(machine);
+        free(threaded);
+        free(initial);
+        return false;
+    }
+
+    bool ok = sim_load(machine, code);
+    if (!ok)
+        fprintf(stderr, "%s: program does not fit in the 11-bit address space\n", input);
+    else
+    {
+        memcpy(initial, machine->memory, TRACS_MEMORY_SIZE);
+        JIT *jit = malloc(sizeof(JIT));
+        SIM_STATUS status;
+        if (jit != NULL && jit_init(jit))
+        {
+            status = jit_run(jit, machine, options->step_limit);
+            jit_free(jit);
+        }
+        else
         {
-            printf("Failed to interpret translation.\n");
-            return 1;
+            threaded_init(threaded);
+            status = threaded_run(threaded, machine, options->step_limit);
         }
+        free(jit);
+        ok = status == SIM_HALTED;
+        // Other workers may be printing their own results
+        flockfile(stdout);
+        if (options->input_count > 1)
+            printf("%s:\n", input);
+        sim_print_state(machine, initial, stdout);
+        funlockfile(stdout);
+    }
+    free(machine);
+    free(threaded);
+    free(initial);
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_program
+*   DESCRIPTION :   This function will run the machine code once per input vector and print a row per vector
+*                   (when memory is watched) and the totals.
+*   ARGUMENTS   :   const char *input, const MACHINE_CODE *code, const OPTIONS *options, STATS *stats
+*   RETURNS     :   bool (true if every vector reached EOP)
+ *==============================================*/
+static bool sweep_program(const char *input, const MACHINE_CODE *code, const OPTIONS *options, STATS *stats)
+{
+    SWEEP sweep = options->sweep;
+    sweep.step_limit = options->step_limit;
+    sweep.jobs = options->jobs;
+    sweep.trace = stats != NULL ? stats->trace : NULL;
+
+    unsigned char image[TRACS_MEMORY_SIZE];
+    if (!buildMemoryImage(code, image, NULL))
+    {
+        fprintf(stderr, "%s: program does not fit in the 11-bit address space\n", input);
+        return false;
+    }
+    if (!sweep_run(&sweep, code))
+    {
+        fprintf(stderr, "%s: could not run the sweep (out of memory or threads)\n", input);
+        sweep_free(&sweep);
+        return false;
+    }
+    if (sweep.watch_count > 0)
+        sweep_print(&sweep, stdout);
+    if (!options->quiet)
+        sweep_print_summary(&sweep, stderr);
+    bool ok = sweep.status_counts[SIM_HALTED] == sweep.vector_count;
+    sweep_free(&sweep);
+    return ok;
+}
 
-        printf("Interpreted translation successfully.\n");
+/*===============================================
+*   FUNCTION    :   use_code
+*   DESCRIPTION :   This function will run assembled code and/or write it in the selected format, as the options say.
+*   ARGUMENTS   :   const char *input, const MACHINE_CODE *code, const OPTIONS *options, STATS *stats (NULL for none)
+*   RETURNS     :   bool
+ *==============================================*/
+static bool use_code(const char *input, const MACHINE_CODE *code, const OPTIONS *options, STATS *stats)
+{
+    // Running replaces writing, unless an output was asked for as well
+    if (options->run)
+    {
+        double started = stats_now();
+        bool ran = options->sweeping ? sweep_program(input, code, options, stats) : run_program(input, code, options);
+        if (stats != NULL)
+            trace_span(stats->trace, options->sweeping ? "sweep" : "run", input, stats->thread, started, stats_now());
+        if ((options->output == NULL && !options->formatGiven) || !ran)
+            return ran;
+    }
 
-        // Printing the contents of the array
-        for (int i = 0; i < line_count; i++)
+    // Input from stdin goes to stdout unless -o says otherwise
+    char *derived = NULL;
+    const char *output = options->output;
+    if (output == NULL && strcmp(input, "-") == 0)
+        output = "-";
+    else if (output == NULL)
+    {
+        derived = output_name(input, options->format);
+        if (derived == NULL)
         {
-            printf("ADDR = %s; BUS = %s; MainMemory();\nADDR = %s; BUS = %s; MainMemory();\n", array[i].opcodeAddress, array[i].opcode, array[i].operandAddress, array[i].operand);
+            fprintf(stderr, "Memory allocation failed\n");
+            return false;
         }
+        output = derived;
+    }
 
-        // Free the allocated memory
-        free(array);
-        return 0;
+    stats_begin(stats, STATS_OUTPUT);
+    bool ok = write_output(input, output, options->format, code);
+    stats_end(stats, code->count / 2, code->count);
+    if (ok && !options->quiet)
+        fprintf(stderr, "%s: Assembly successful! (%d instructions -> %s)\n", input, code->count / 2, strcmp(output, "-") == 0 ? "stdout" : output);
+    free(derived);
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_file
+*   DESCRIPTION :   This function will assemble one input and write it in the selected format.
+*   ARGUMENTS   :   const char *input, const OPTIONS *options, const TRACS_ALLOCATOR *allocator, STATS *stats (NULL for none)
+*   RETURNS     :   bool
+ *==============================================*/
+static bool assemble_file(const char *input, const OPTIONS *options, const TRACS_ALLOCATOR *allocator, STATS *stats)
+{
+    MACHINE_CODE code;
+    bool assembled = options->cache != NULL ? cache_assemble(options->cache, input, &code, allocator, options->optimize, stats)
+                                            : assemble(input, &code, allocator, options->optimize, stats);
+    if (!assembled)
+    {
+        fprintf(stderr, "%s: Assembly failed!\n", input);
+        return false;
     }
-    else
+
+    bool ok = use_code(input, &code, options, stats);
+    freeMachineCode(&code);
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   watched
+*   DESCRIPTION :   This function will run or write the code of a watched input each time it is rebuilt.
+*   ARGUMENTS   :   const char *input, const MACHINE_CODE *code, void *context (const OPTIONS *)
+*   RETURNS     :   bool
+ *==============================================*/
+static bool watched(const char *input, const MACHINE_CODE *code, void *context)
+{
+    return use_code(input, code, context, NULL);
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_job
+*   DESCRIPTION :   This function will run one input of a batch on a pool worker. Each job owns all of its
+*                   assembler state, taken from the worker's arena, so jobs share nothing but the read-only
+*                   options.
+*   ARGUMENTS   :   int index, int worker, void *context (JOB_BATCH *)
+*   RETURNS     :   VOID
+ *==============================================*/
+static void assemble_job(int index, int worker, void *context)
+{
+    JOB_BATCH *batch = context;
+    STATS *stats = batch->stats != NULL ? &batch->stats[index] : NULL;
+    double started = stats_now();
+    if (stats != NULL)
+        stats->thread = worker;
+    ARENA *arena = &batch->arenas[worker];
+    batch->succeeded[index] = assemble_file(batch->options->inputs[index], batch->options, &arena->allocator, stats);
+    arena_reset(arena);
+    if (stats != NULL)
+        trace_span(stats->trace, "assemble", stats->input, worker, started, stats_now());
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_default
+*   DESCRIPTION :   This function will run the original no-argument flow: assemble script.asm, write
+*                   translation.txt, .bin and .hex, and print the MainMemory() statements.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   int
+ *==============================================*/
+static int assemble_default(void)
+{
+    MACHINE_CODE code;
+    if (!assemble(DEFAULT_INPUT, &code, NULL, OPTIMIZE_NONE, NULL))
     {
         printf("Assembly failed!\n");
-        return 0;
+        return 1;
+    }
+    printf("Assembly successful!\n");
+
+    // The machine code stays in memory; the files are only outputs for other tools
+    if (!write_output(DEFAULT_INPUT, "translation.txt", &formats[0], &code) ||
+        !write_output(DEFAULT_INPUT, "translation.bin", &formats[1], &code) ||
+        !write_output(DEFAULT_INPUT, "translation.hex", &formats[2], &code))
+    {
+        freeMachineCode(&code);
+        return 1;
+    }
+
+    // Printing the contents of the machine code
+    printMainMemory(&code, stdout);
+
+    // Free the allocated memory
+    freeMachineCode(&code);
+    return 0;
+}
+
+/*===============================================
+*   FUNCTION    :   print_stats
+*   DESCRIPTION :   This function will print the --stats of every input, and their total for a batch, to stderr.
+*   ARGUMENTS   :   const OPTIONS *options, const STATS *stats, double seconds
+*   RETURNS     :   VOID
+ *==============================================*/
+static void print_stats(const OPTIONS *options, const STATS *stats, double seconds)
+{
+    if (options->stats == STATS_JSON)
+    {
+        fprintf(stderr, "{\"wall_seconds\":%.9f,\"inputs\":[", seconds);
+        for (int i = 0; i < options->input_count; i++)
+        {
+            if (i > 0)
+                fputc(',', stderr);
+            stats_print_json(&stats[i], options->inputs[i], stderr);
+        }
+        fprintf(stderr, "]}\n");
+        return;
+    }
+
+    STATS total;
+    stats_init(&total);
+    for (int i = 0; i < options->input_count; i++)
+    {
+        stats_print(&stats[i], strcmp(options->inputs[i], "-") == 0 ? "<stdin>" : options->inputs[i], stderr);
+        stats_add(&total, &stats[i]);
+    }
+    if (options->input_count > 1)
+    {
+        stats_print(&total, "all inputs", stderr);
+        fprintf(stderr, "  wall time %.3f ms\n", seconds * 1e3);
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   usage
+*   DESCRIPTION :   This function will print the command-line help.
+*   ARGUMENTS   :   FILE *file, const char *program
+*   RETURNS     :   VOID
+ *==============================================*/
+static void usage(FILE *file, const char *program)
+{
+    fprintf(file,
+        "Usage: %s [options] [file.asm ...]\n"
+        "Assembles TRACS assembly. With no arguments, assembles " DEFAULT_INPUT " into translation.txt/.bin/.hex.\n"
+        "  -o FILE     write the output to FILE ('-' for stdout); default is the input name with the\n"
+        "              format's extension, or stdout when reading stdin\n"
+        "  -f FORMAT   output format: txt (translation.txt lines, default), bin (2 KB memory image),\n"
+        "              hex (Intel HEX), c (MainMemory() statements)\n"
+        "  -q          quiet, only report errors\n"
+        "  -j JOBS     assemble up to JOBS inputs at once (default: one per core)\n"
+        "  -r          run the program on the simulator and print the final registers and changed\n"
+        "              memory; no output file is written unless -o or -f is also given\n"
+        "  -m STEPS    stop a run after STEPS instructions (default: %llu, 0 for no limit)\n"
+        "  -s INPUTS   run once for every combination of input memory values, on every core; INPUTS\n"
+        "              is ADDRESS=LOW-HIGH or ADDRESS=VALUE, comma-separated, e.g. 0x400=0-255,0x401=3\n"
+        "  -w RANGE    with -s, print the memory FIRST-LAST (or one ADDRESS) of every run as CSV\n"
+        "  --stats[=json]  print the time, lines/s, bytes/s, allocations and peak memory of each\n"
+        "              phase to stderr, as text or JSON\n"
+        "  --trace FILE    write a Chrome trace-event JSON file with a span for every phase, input,\n"
+        "              run and sweep chunk, on one track per thread (open it in ui.perfetto.dev)\n"
+        "  --cache DIR     keep every result in DIR, keyed by a hash of the source and assembler\n"
+        "              version, and reuse it instead of assembling an unchanged source again\n"
+        "  --watch         keep running, and reassemble (and run, with -r) each input whenever it is\n"
+        "              saved; edits to a program without errors only re-encode the changed lines\n"
+        "  -O[LEVEL]   remove redundant instructions once the program assembles; -O and -O1 apply a\n"
+        "              table of peephole rewrites, -O2 also removes dead stores and reloads found by\n"
+        "              data-flow analysis of the whole program, -O3 also folds values known at assembly\n"
+        "              time into WB, -O0 (the default) leaves the program as written\n"
+        "  -h          show this help\n"
+        "A file name of '-' reads the source from stdin.\n", program, SIM_DEFAULT_STEP_LIMIT);
+}
+
+/*===============================================
+*   FUNCTION    :   main
+*   DESCRIPTION :   This function will parse the command line and assemble every input.
+*   ARGUMENTS   :   int argc, char *argv[]
+*   RETURNS     :   int (0 if every input assembled)
+ *==============================================*/
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+        return assemble_default();
+
+    OPTIONS options = { NULL, 0, NULL, &formats[0], false, false, 0, false, SIM_DEFAULT_STEP_LIMIT, false };
+    sweep_init(&options.sweep);
+    options.inputs = malloc(argc * sizeof(char *));
+    if (options.inputs == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0)
+        {
+            usage(stdout, argv[0]);
+            free(options.inputs);
+            return 0;
+        }
+        else if (strcmp(arg, "-q") == 0)
+            options.quiet = true;
+        else if (strcmp(arg, "-r") == 0)
+            options.run = true;
+        else if (strcmp(arg, "--watch") == 0)
+            options.watch = true;
+        else if (strncmp(arg, "-O", 2) == 0)
+        {
+            // -O alone is the peephole pass, -O0 turns optimization off again
+            char *end;
+            long level = arg[2] == '\0' ? OPTIMIZE_PEEPHOLE : strtol(arg + 2, &end, 10);
+            if ((arg[2] != '\0' && *end != '\0') || level < OPTIMIZE_NONE || level > OPTIMIZE_MAX)
+            {
+                fprintf(stderr, "Invalid optimization level: %s\n", arg);
+                free(options.inputs);
+                return 2;
+            }
+            options.optimize = (int)level;
+        }
+        else if (strcmp(arg, "--stats") == 0 || strcmp(arg, "--stats=text") == 0)
+            options.stats = STATS_TEXT;
+        else if (strcmp(arg, "--stats=json") == 0)
+            options.stats = STATS_JSON;
+        else if (strcmp(arg, "--trace") == 0 || strcmp(arg, "--cache") == 0)
+        {
+            if (i + 1 == argc)
+            {
+                fprintf(stderr, "Missing argument for %s\n", arg);
+                free(options.inputs);
+                return 2;
+            }
+            if (arg[2] == 't')
+                options.trace = argv[++i];
+            else
+                options.cache = argv[++i];
+        }
+        else if (strcmp(arg, "-o") == 0 || strcmp(arg, "-f") == 0 || strcmp(arg, "-j") == 0 || strcmp(arg, "-m") == 0 ||
+                 strcmp(arg, "-s") == 0 || strcmp(arg, "-w") == 0)
+        {
+            if (i + 1 == argc)
+            {
+                fprintf(stderr, "Missing argument for %s\n", arg);
+                free(options.inputs);
+                return 2;
+            }
+            const char *value = argv[++i];
+            if (arg[1] == 'o')
+                options.output = value;
+            else if (arg[1] == 'j')
+            {
+                char *end;
+                long jobs = strtol(value, &end, 10);
+                if (*end != '\0' || jobs < 0)
+                {
+                    fprintf(stderr, "Invalid job count: %s\n", value);
+                    free(options.inputs);
+                    return 2;
+                }
+                options.jobs = (int)jobs;
+            }
+            else if (arg[1] == 'm')
+            {
+                char *end;
+                options.step_limit = strtoull(value, &end, 0);
+                if (*end != '\0' || value[0] == '-')
+                {
+                    fprintf(stderr, "Invalid step limit: %s\n", value);
+                    free(options.inputs);
+                    return 2;
+                }
+            }
+            else if (arg[1] == 's')
+            {
+                options.run = true;
+                options.sweeping = true;
+                if (!sweep_parse_inputs(&options.sweep, value))
+                {
+                    fprintf(stderr, "Invalid sweep inputs: %s\n", value);
+                    free(options.inputs);
+                    return 2;
+                }
+            }
+            else if (arg[1] == 'w')
+            {
+                if (!sweep_parse_watch(&options.sweep, value))
+                {
+                    fprintf(stderr, "Invalid watch range: %s\n", value);
+                    free(options.inputs);
+                    return 2;
+                }
+            }
+            else
+            {
+                options.formatGiven = true;
+                options.format = NULL;
+                for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+                {
+                    if (strcmp(value, formats[f].name) == 0)
+                        options.format = &formats[f];
+                }
+                if (options.format == NULL)
+                {
+                    fprintf(stderr, "Unknown output format: %s\n", value);
+                    free(options.inputs);
+                    return 2;
+                }
+            }
+        }
+        else if (arg[0] == '-' && arg[1] != '\0')
+        {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            usage(stderr, argv[0]);
+            free(options.inputs);
+            return 2;
+        }
+        else
+            options.inputs[options.input_count++] = arg;
+    }
+
+    if (options.input_count == 0)
+        options.inputs[options.input_count++] = DEFAULT_INPUT;
+    if (options.output != NULL && options.input_count > 1)
+    {
+        fprintf(stderr, "-o cannot be used with more than one input\n");
+        free(options.inputs);
+        return 2;
+    }
+    if (options.sweeping && options.input_count > 1)
+    {
+        fprintf(stderr, "-s cannot be used with more than one input\n");
+        free(options.inputs);
+        return 2;
+    }
+
+    if (options.watch)
+    {
+        for (int i = 0; i < options.input_count; i++)
+        {
+            if (strcmp(options.inputs[i], "-") == 0)
+            {
+                fprintf(stderr, "--watch cannot read stdin\n");
+                free(options.inputs);
+                return 2;
+            }
+        }
+        if (options.stats != STATS_NONE || options.trace != NULL || options.cache != NULL)
+        {
+            fprintf(stderr, "--watch cannot be used with --stats, --trace or --cache\n");
+            free(options.inputs);
+            return 2;
+        }
+        int status = watch_run(options.inputs, options.input_count, options.optimize, options.quiet, watched, &options);
+        free(options.inputs);
+        return status;
+    }
+    if (options.cache != NULL && !cache_init(options.cache))
+    {
+        fprintf(stderr, "Cannot create cache directory %s\n", options.cache);
+        free(options.inputs);
+        return 1;
+    }
+
+    // Phases are timed for --trace as well, since the spans come from the same hooks
+    TRACE trace;
+    bool measuring = options.stats != STATS_NONE || options.trace != NULL;
+    if (options.trace != NULL)
+        trace_init(&trace);
+    int workers = options.jobs > 0 ? options.jobs : pool_default_workers();
+    JOB_BATCH batch = { &options, calloc(options.input_count, sizeof(bool)), NULL, malloc(workers * sizeof(ARENA)) };
+    for (int i = 0; batch.arenas != NULL && i < workers; i++)
+        arena_init(&batch.arenas[i]);
+    if (measuring)
+    {
+        batch.stats = malloc(options.input_count * sizeof(STATS));
+        for (int i = 0; batch.stats != NULL && i < options.input_count; i++)
+        {
+            stats_init(&batch.stats[i]);
+            batch.stats[i].trace = options.trace != NULL ? &trace : NULL;
+            batch.stats[i].input = options.inputs[i];
+        }
+    }
+    if (batch.succeeded == NULL || batch.arenas == NULL || (measuring && batch.stats == NULL))
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(batch.succeeded);
+        free(batch.arenas);
+        free(batch.stats);
+        free(options.inputs);
+        return 1;
+    }
+    double started = stats_now();
+    if (!pool_run(options.input_count, workers, assemble_job, &batch))
+    {
+        fprintf(stderr, "Could not start the worker threads\n");
+        free(batch.succeeded);
+        free(batch.arenas);
+        free(batch.stats);
+        free(options.inputs);
+        return 1;
+    }
+    if (options.stats != STATS_NONE)
+        print_stats(&options, batch.stats, stats_now() - started);
+    bool traced = true;
+    if (options.trace != NULL)
+    {
+        trace_span(&trace, "batch", NULL, 0, started, stats_now());
+        traced = trace_write(&trace, options.trace);
+        if (!traced)
+            fprintf(stderr, "Error writing %s\n", options.trace);
+        trace_free(&trace);
+    }
+
+    int failures = 0;
+    for (int i = 0; i < options.input_count; i++)
+    {
+        if (!batch.succeeded[i])
+            failures++;
     }
+    if (options.input_count > 1 && !options.quiet)
+        fprintf(stderr, "%d of %d inputs assembled.\n", options.input_count - failures, options.input_count);
+    for (int i = 0; i < workers; i++)
+        arena_free(&batch.arenas[i]);
+    free(batch.succeeded);
+    free(batch.arenas);
+    free(batch.stats);
+    free(options.inputs);
+    return failures == 0 && traced ? 0 : 1;
 }
@@ -0,0 +1,22 @@
+/*======================================================================================================
+* FILE        : opcodes.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the TRACS mnemonic table, laid out at compile time by its perfect hash.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created, replaces the strcmp chains in get_opcode() and process_file().
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include "opcodes.h"
+
+const MNEMONIC mnemonic_table[MNEMONIC_SLOTS] = {
+#define X(name, a, b, c, d, opcode, kind) \
+    [MNEMONIC_SLOT(MNEMONIC_KEY(a, b, c, d))] = { MNEMONIC_KEY(a, b, c, d), #name, opcode, kind, kind == OPERAND_LABEL },
+    TRACS_MNEMONICS(X)
+#undef X
+};
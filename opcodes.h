@@ -0,0 +1,98 @@
+#ifndef OPCODES_H
+#define OPCODES_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum operandKind {
+    OPERAND_NONE,       // No operand, second byte is 0x00
+    OPERAND_IMMEDIATE,  // 8-bit value in the second byte
+    OPERAND_ADDRESS,    // 11-bit memory or I/O address
+    OPERAND_LABEL       // 11-bit branch target, usually a label
+} OPERAND_KIND;
+
+typedef struct mnemonic {
+    uint32_t key;       // Packed mnemonic bytes, 0 marks an empty slot
+    const char *name;
+    unsigned char opcode;
+    OPERAND_KIND kind;
+    bool isBranch;
+} MNEMONIC;
+
+/*
+ * Every TRACS mnemonic, in one place. The lexer and the encoder both go through mnemonic_lookup(), so
+ * adding an instruction here is all that is needed. Mnemonics are at most four characters and are
+ * packed little-endian into a 32-bit key.
+ */
+#define TRACS_MNEMONICS(X) \
+    X(WB,   'W', 'B',  0 ,  0 , 0x30, OPERAND_IMMEDIATE) \
+    X(WM,   'W', 'M',  0 ,  0 , 0x08, OPERAND_ADDRESS)   \
+    X(RM,   'R', 'M',  0 ,  0 , 0x10, OPERAND_ADDRESS)   \
+    X(WACC, 'W', 'A', 'C', 'C', 0x48, OPERAND_NONE)      \
+    X(WIB,  'W', 'I', 'B',  0 , 0x38, OPERAND_IMMEDIATE) \
+    X(WIO,  'W', 'I', 'O',  0 , 0x28, OPERAND_ADDRESS)   \
+    X(RACC, 'R', 'A', 'C', 'C', 0x58, OPERAND_NONE)      \
+    X(ADD,  'A', 'D', 'D',  0 , 0xF0, OPERAND_NONE)      \
+    X(SUB,  'S', 'U', 'B',  0 , 0xE8, OPERAND_NONE)      \
+    X(MUL,  'M', 'U', 'L',  0 , 0xD8, OPERAND_NONE)      \
+    X(AND,  'A', 'N', 'D',  0 , 0xD0, OPERAND_NONE)      \
+    X(OR,   'O', 'R',  0 ,  0 , 0xC8, OPERAND_NONE)      \
+    X(NOT,  'N', 'O', 'T',  0 , 0xC0, OPERAND_NONE)      \
+    X(XOR,  'X', 'O', 'R',  0 , 0xB8, OPERAND_NONE)      \
+    X(SHL,  'S', 'H', 'L',  0 , 0xB0, OPERAND_NONE)      \
+    X(SHR,  'S', 'H', 'R',  0 , 0xA8, OPERAND_NONE)      \
+    X(BR,   'B', 'R',  0 ,  0 , 0x18, OPERAND_LABEL)     \
+    X(BRE,  'B', 'R', 'E',  0 , 0xA0, OPERAND_LABEL)     \
+    X(BRNE, 'B', 'R', 'N', 'E', 0x98, OPERAND_LABEL)     \
+    X(BRGT, 'B', 'R', 'G', 'T', 0x90, OPERAND_LABEL)     \
+    X(BRLT, 'B', 'R', 'L', 'T', 0x88, OPERAND_LABEL)     \
+    X(EOP,  'E', 'O', 'P',  0 , 0xF8, OPERAND_NONE)      \
+    X(SWAP, 'S', 'W', 'A', 'P', 0x70, OPERAND_NONE)
+
+// OP_WB, OP_WM, ...: opcode byte values (operand bits clear) for use in switch statements
+enum {
+#define X(name, a, b, c, d, opcode, kind) OP_##name = opcode,
+    TRACS_MNEMONICS(X)
+#undef X
+};
+
+#define OPCODE_MASK 0xF8    // Top five bits of the first instruction byte
+
+/*
+ * Perfect hash: the multiplier was searched offline so that all keys above land in distinct slots.
+ * The table is built with designated initializers, so a collision after editing the list overwrites an
+ * entry. -Wall does not report that, so the project builds with -Werror=override-init, which turns it
+ * into an error in opcodes.c; pick a new multiplier if that happens.
+ */
+#define MNEMONIC_KEY(a, b, c, d)    ((uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+#define MNEMONIC_HASH_MULTIPLIER    0x08F4D643u
+#define MNEMONIC_SLOT_BITS          5
+#define MNEMONIC_SLOTS              (1 << MNEMONIC_SLOT_BITS)
+#define MNEMONIC_SLOT(key)          ((uint32_t)((uint32_t)(key) * MNEMONIC_HASH_MULTIPLIER) >> (32 - MNEMONIC_SLOT_BITS))
+
+extern const MNEMONIC mnemonic_table[MNEMONIC_SLOTS];
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+/*===============================================
+*   FUNCTION    :   mnemonic_lookup
+*   DESCRIPTION :   This function will return the table entry for a mnemonic, or NULL if it is not one.
+*   ARGUMENTS   :   const char *text, size_t length
+*   RETURNS     :   const MNEMONIC *
+ *==============================================*/
+static inline const MNEMONIC *mnemonic_lookup(const char *text, size_t length)
+{
+    if (length == 0 || length > 4)
+        return NULL;
+    uint32_t key = 0;
+    for (size_t i = 0; i < length; i++)
+        key |= (uint32_t)(unsigned char)text[i] << (8 * i);
+    const MNEMONIC *entry = &mnemonic_table[MNEMONIC_SLOT(key)];
+    return entry->key == key ? entry : NULL;
+}
+
+#endif
@@ -0,0 +1,961 @@
+/*======================================================================================================
+* FILE        : optimizer.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the optional -O passes, which run on the lines of a program that has
+*               already assembled without errors, so no line they remove or rewrite can hide an error.
+*               Removing a line is all a pass does; assemble_program() then lays out the remaining lines
+*               again, so every label gets its new address for free.
+*
+*               The peephole pass applies the rewrite table below to neighbouring instructions until
+*               nothing changes. The data-flow pass (-O2) solves, over the basic blocks, which cells MBR is
+*               known to hold and which registers and cells are live, and removes the reloads and dead writes
+*               that this shows. Constant folding (-O3) follows known values through each block and turns
+*               loads and ALU results into WB, so that the next data-flow round removes what computed them.
+*               A line with a label can be reached from elsewhere, so no rewrite looks across one. Programs
+*               that read or write their own code, branch to a fixed address, or run off the end of an ORG
+*               block into the next one are left as they are, since moving their code would change what
+*               they do.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Data-flow pass for dead stores and redundant loads.
+*   16 October, 2026: V1.2 - Constant folding (-O3), and removal of unreachable blocks.
+*   16 October, 2026: V1.3 - Only programs that assembled are optimized, and they are encoded again.
+*   16 October, 2026: V1.4 - A line whose operand does not encode as written is a barrier, and never pure.
+*   16 October, 2026: V1.5 - Unreachable blocks are only removed at -O3, and never a branch to an unknown label.
+*   16 October, 2026: V1.6 - A program with an ORG address outside the address space is left as it is.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "allocator.h"
+#include "optimizer.h"
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define NOT_AN_INSTRUCTION  -1  // ORG lines and lines that do not assemble; no rewrite touches them
+
+typedef struct decodedLine {
+    int opcode;             // Opcode byte, or NOT_AN_INSTRUCTION
+    unsigned long operand;  // Numeric operand, 0 if none
+    bool numeric;           // The operand is a number
+    bool removed;
+} DECODED_LINE;
+
+// Bits of a data-flow set: the registers, then one for every memory cell that some RM or WM names
+#define FLOW_MBR            0x01
+#define FLOW_ACC            0x02
+#define FLOW_IOB            0x04
+#define FLOW_FLAGS          0x08
+#define FLOW_CELLS          4       // Bit of the first memory cell
+#define FLOW_NONE           -1      // No successor
+#define FLOW_EXIT           -2      // Successor outside the code, where everything can be observed
+
+typedef struct effect {
+    unsigned char uses;     // FLOW_* registers read
+    unsigned char defs;     // FLOW_* registers written
+    bool pure;              // Does nothing but write defs (and the cell of a WM), so it can go once they are dead
+} EFFECT;
+
+typedef struct flowGraph {
+    int *order;             // Lines not removed yet, in program order
+    int count;
+    int *block;             // Block of every position in order
+    int *first;             // First position of every block, and one past the last block
+    int block_count;
+    int *successors;        // Two per block, FLOW_NONE or FLOW_EXIT when there is no block
+    int *predecessors;      // Those of block b start at pred_first[b] and end at pred_first[b + 1]
+    int *pred_first;
+    bool *entry;            // Control can also arrive from outside: the start, and after an ORG or a barrier
+    bool *halts;            // Some path from the block reaches EOP or leaves the code
+    short cell[TRACS_MEMORY_SIZE];  // Cell index of every address an RM or WM names, -1 for the rest
+    int cell_count;
+    int words;              // 64-bit words in one set
+    unsigned long long *sets;       // One per block
+    unsigned long long *scratch;    // One more, for walking a block
+    unsigned char *live_after;      // FLOW_* registers live after every position, from the last liveness walk
+} FLOW_GRAPH;
+
+// Room after the source for "\nWB WACC BR ", every byte value as "0xNN " and snprintf()'s NUL
+#define SPELLING_ROOM       (12 + 256 * 5 + 1)
+
+/*
+ * Text for the lines constant folding rewrites. Tokens can only point into the source text, so on the
+ * first rewrite the text is copied into a buffer with SPELLING_ROOM to spare, which the SOURCE then owns,
+ * and the mnemonics and values are written there. Nothing past source.size is ever lexed again.
+ */
+typedef struct spelling {
+    bool copied;            // The source text has been copied, or the copy failed if text is still NULL
+    char *text;
+    unsigned int used;      // Bytes written after the source
+    TOKEN wb, wacc, br;
+    TOKEN values[256];      // Length 0 until the value is first needed
+} SPELLING;
+
+typedef struct constants {
+    bool mbr_known, acc_known, iob_known;
+    unsigned char mbr, acc, iob;
+    unsigned char *cells;   // Value of every cell, known only where stamps[cell] is the current block's stamp
+    int *stamps;
+    int stamp;
+} CONSTANTS;
+
+typedef struct segment {
+    unsigned int origin;    // Address of the first instruction after the ORG
+    unsigned int end;       // Just past the last instruction
+    int last;               // Index of the last line, -1 if there is none
+} SEGMENT;
+
+// Writers that do not read MBR: WB, RM and RACC only set it, so one right after another makes it dead
+static const PEEPHOLE_RULE peephole_rules[] = {
+    { OP_WM,   OP_RM,   true,  DROP_SECOND },     // WM a; RM a: MBR already holds memory[a]
+    { OP_WM,   OP_WM,   true,  DROP_SECOND },     // WM a; WM a: the same value again
+    { OP_WACC, OP_RACC, false, DROP_SECOND },     // WACC; RACC: MBR already equals ACC
+    { OP_RACC, OP_WACC, false, DROP_SECOND },     // RACC; WACC: ACC already equals MBR
+    { OP_RACC, OP_RACC, false, DROP_SECOND },     // RACC; RACC
+    { OP_WB,   OP_WB,   false, DROP_FIRST },
+    { OP_WB,   OP_RM,   false, DROP_FIRST },
+    { OP_WB,   OP_RACC, false, DROP_FIRST },
+    { OP_RM,   OP_WB,   false, DROP_FIRST },
+    { OP_RM,   OP_RM,   false, DROP_FIRST },
+    { OP_RM,   OP_RACC, false, DROP_FIRST },
+    { OP_RACC, OP_WB,   false, DROP_FIRST },
+    { OP_RACC, OP_RM,   false, DROP_FIRST },
+    { OP_WIB,  OP_WIB,  false, DROP_FIRST },      // IOB is replaced before WIO or SWAP reads it
+};
+
+/*===============================================
+*   FUNCTION    :   find_rule
+*   DESCRIPTION :   This function will look up the rewrite for two neighbouring instructions.
+*   ARGUMENTS   :   const DECODED_LINE *first, const DECODED_LINE *second
+*   RETURNS     :   const PEEPHOLE_RULE * (NULL if none applies)
+ *==============================================*/
+static const PEEPHOLE_RULE *find_rule(const DECODED_LINE *first, const DECODED_LINE *second)
+{
+    for (size_t i = 0; i < sizeof(peephole_rules) / sizeof(peephole_rules[0]); i++) {
+        const PEEPHOLE_RULE *rule = &peephole_rules[i];
+        if (rule->first != first->opcode || rule->second != second->opcode)
+            continue;
+        if (rule->same_operand && !(first->numeric && second->numeric && first->operand == second->operand))
+            continue;
+        return rule;
+    }
+    return NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   decode_lines
+*   DESCRIPTION :   This function will decode the opcode and operand of every line, and check that the program's
+*                   code can be moved: no RM or WM of an address inside it, no branch to a fixed address.
+*                   An ORG block that can run on into the block right after it is not touched, and neither is
+*                   a line whose operand is not a number the instruction holds, such as a label on a non-branch.
+*   ARGUMENTS   :   const PROGRAM *program, DECODED_LINE *lines, SEGMENT *segments, DIAGNOSTICS *diagnostics
+*   RETURNS     :   bool (false if the program must be left as it is)
+ *==============================================*/
+static bool decode_lines(const PROGRAM *program, DECODED_LINE *lines, SEGMENT *segments, DIAGNOSTICS *diagnostics)
+{
+    int segment_count = 0;
+    SEGMENT *segment = &segments[segment_count++];
+    segment->origin = segment->end = 0;
+    segment->last = -1;
+    for (int i = 0; i < program->line_count; i++) {
+        const LINE *line = &program->lines[i];
+        DECODED_LINE *decoded = &lines[i];
+        memset(decoded, 0, sizeof(*decoded));
+        decoded->opcode = NOT_AN_INSTRUCTION;
+        if (token_equals(program, line->label, "ORG")) {
+            unsigned long origin;
+            if (!token_number(program, line->operation, &origin) || origin >= TRACS_MEMORY_SIZE)
+                return false;
+            segment = &segments[segment_count++];
+            segment->origin = segment->end = (unsigned int)origin;
+            segment->last = -1;
+            continue;
+        }
+        segment->end += 2;
+        segment->last = i;
+
+        const MNEMONIC *op = mnemonic_lookup(token_text(program, line->operation), line->operation.length);
+        if (op == NULL)
+            continue;
+        decoded->numeric = line->operand.length != 0 && token_is_number(program, line->operand);
+        if (decoded->numeric && !token_number(program, line->operand, &decoded->operand))
+            continue;
+        if ((line->operand.length != 0 && !decoded->numeric && !op->isBranch) || decoded->operand > operand_limit(op))
+            continue;
+        decoded->opcode = op->opcode;
+        if (op->isBranch && decoded->numeric) {
+            report(diagnostics, TRACS_WARNING, line->number, "Not optimized: branch to the fixed address 0x%03lx", decoded->operand);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < program->line_count; i++) {
+        if (lines[i].opcode != OP_RM && lines[i].opcode != OP_WM)
+            continue;
+        unsigned long address = lines[i].operand & 0x7FF;
+        for (int s = 0; s < segment_count; s++) {
+            if (address >= segments[s].origin && address < segments[s].end) {
+                report(diagnostics, TRACS_WARNING, program->lines[i].number,
+                       "Not optimized: %s 0x%03lx reads or writes the program's own code", lines[i].opcode == OP_RM ? "RM" : "WM", address);
+                return false;
+            }
+        }
+    }
+
+    // Without a branch or EOP at its end, a block runs on into whatever follows it in memory
+    for (int s = 0; s < segment_count; s++) {
+        int last = segments[s].last;
+        if (last == -1 || lines[last].opcode == OP_BR || lines[last].opcode == OP_EOP)
+            continue;
+        bool adjacent = false;
+        for (int t = 0; t < segment_count; t++)
+            adjacent = adjacent || (t != s && segments[t].last != -1 && segments[t].origin == segments[s].end);
+        for (int i = last; adjacent && i >= 0 && !token_equals(program, program->lines[i].label, "ORG"); i--)
+            lines[i].opcode = NOT_AN_INSTRUCTION;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   peephole
+*   DESCRIPTION :   This function will apply the rewrite table until nothing changes. A branch to the very next
+*                   line is dropped as well.
+*   ARGUMENTS   :   const PROGRAM *program, DECODED_LINE *lines
+*   RETURNS     :   int (instructions removed)
+ *==============================================*/
+static int peephole(const PROGRAM *program, DECODED_LINE *lines)
+{
+    int removed = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        int previous = -1;
+        for (int i = 0; i < program->line_count; i++) {
+            if (lines[i].removed)
+                continue;
+            const LINE *line = &program->lines[i];
+            if (previous == -1 || lines[previous].opcode == NOT_AN_INSTRUCTION || lines[i].opcode == NOT_AN_INSTRUCTION) {
+                previous = i;
+                continue;
+            }
+            const LINE *before = &program->lines[previous];
+
+            // BR L right before L:
+            if (lines[previous].opcode == OP_BR && before->label.length == 0 && line->label.length == before->operand.length &&
+                memcmp(token_text(program, line->label), token_text(program, before->operand), line->label.length) == 0) {
+                lines[previous].removed = true;
+                removed++;
+                changed = true;
+                previous = i;
+                continue;
+            }
+
+            // Control can reach a labelled line from elsewhere, so it cannot be merged with the line before it
+            const PEEPHOLE_RULE *rule = line->label.length == 0 ? find_rule(&lines[previous], &lines[i]) : NULL;
+            if (rule != NULL && rule->action == DROP_SECOND) {
+                lines[i].removed = true;
+                removed++;
+                changed = true;
+                continue;
+            }
+            if (rule != NULL && rule->action == DROP_FIRST && before->label.length == 0) {
+                lines[previous].removed = true;
+                removed++;
+                changed = true;
+            }
+            previous = i;
+        }
+    }
+    return removed;
+}
+
+/*===============================================
+*   FUNCTION    :   is_branch
+*   DESCRIPTION :   This function will tell whether an opcode is BR or one of the conditional branches.
+*   ARGUMENTS   :   int opcode
+*   RETURNS     :   bool
+ *==============================================*/
+static bool is_branch(int opcode)
+{
+    return opcode == OP_BR || opcode == OP_BRE || opcode == OP_BRNE || opcode == OP_BRGT || opcode == OP_BRLT;
+}
+
+/*===============================================
+*   FUNCTION    :   effect_of
+*   DESCRIPTION :   This function will give the registers an instruction reads and writes, as the simulator runs it.
+*                   Every ALU instruction and every conditional branch sets all of the flags. The memory cell of
+*                   RM and WM is left to the caller.
+*   ARGUMENTS   :   int opcode
+*   RETURNS     :   EFFECT
+ *==============================================*/
+static EFFECT effect_of(int opcode)
+{
+    switch (opcode) {
+    case OP_WB:   return (EFFECT){ 0, FLOW_MBR, true };
+    case OP_WM:   return (EFFECT){ FLOW_MBR, 0, true };
+    case OP_RM:   return (EFFECT){ 0, FLOW_MBR, true };
+    case OP_WACC: return (EFFECT){ FLOW_MBR, FLOW_ACC, true };
+    case OP_WIB:  return (EFFECT){ 0, FLOW_IOB, true };
+    case OP_WIO:  return (EFFECT){ FLOW_IOB, 0, false };
+    case OP_RACC: return (EFFECT){ FLOW_ACC, FLOW_MBR, true };
+    case OP_SWAP: return (EFFECT){ FLOW_MBR | FLOW_IOB, FLOW_MBR | FLOW_IOB, true };
+    case OP_ADD: case OP_SUB: case OP_MUL: case OP_AND: case OP_OR: case OP_XOR:
+        return (EFFECT){ FLOW_ACC | FLOW_MBR, FLOW_ACC | FLOW_FLAGS, true };
+    case OP_NOT: case OP_SHL: case OP_SHR:
+        return (EFFECT){ FLOW_ACC, FLOW_ACC | FLOW_FLAGS, true };
+    case OP_BRE: case OP_BRNE: case OP_BRGT: case OP_BRLT:
+        return (EFFECT){ FLOW_ACC | FLOW_MBR, FLOW_FLAGS, false };
+    default:      return (EFFECT){ 0, 0, false };
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   has_bit, set_bit, clear_bit
+*   DESCRIPTION :   These functions will test, add and remove one bit of a data-flow set.
+*   ARGUMENTS   :   (const) unsigned long long *set, int bit
+*   RETURNS     :   bool / VOID
+ *==============================================*/
+static bool has_bit(const unsigned long long *set, int bit)
+{
+    return (set[bit / 64] >> (bit % 64)) & 1;
+}
+
+static void set_bit(unsigned long long *set, int bit)
+{
+    set[bit / 64] |= 1ULL << (bit % 64);
+}
+
+static void clear_bit(unsigned long long *set, int bit)
+{
+    set[bit / 64] &= ~(1ULL << (bit % 64));
+}
+
+/*===============================================
+*   FUNCTION    :   free_graph
+*   DESCRIPTION :   This function will release whatever build_graph() allocated.
+*   ARGUMENTS   :   const TRACS_ALLOCATOR *allocator, FLOW_GRAPH *graph
+*   RETURNS     :   VOID
+ *==============================================*/
+static void free_graph(const TRACS_ALLOCATOR *allocator, FLOW_GRAPH *graph)
+{
+    void *arrays[] = { graph->order, graph->block, graph->first, graph->successors, graph->predecessors,
+                       graph->pred_first, graph->entry, graph->halts, graph->sets, graph->scratch,
+                       graph->live_after };
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); i++) {
+        if (arrays[i] != NULL)
+            RELEASE(allocator, arrays[i]);
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   build_graph
+*   DESCRIPTION :   This function will split the remaining lines into basic blocks, which start at a label, after
+*                   a branch or EOP, and around every barrier line, and link each block to the blocks control can
+*                   go to next. It also numbers the memory cells RM and WM name, and marks the blocks from which
+*                   the program can halt; in a loop that never does, everything is kept.
+*   ARGUMENTS   :   const PROGRAM *program, const DECODED_LINE *lines, FLOW_GRAPH *graph
+*   RETURNS     :   bool (false if memory ran out)
+ *==============================================*/
+static bool build_graph(const PROGRAM *program, const DECODED_LINE *lines, FLOW_GRAPH *graph)
+{
+    const TRACS_ALLOCATOR *allocator = program->allocator;
+    memset(graph, 0, sizeof(*graph));
+    memset(graph->cell, 0xFF, sizeof(graph->cell));
+    for (int i = 0; i < program->line_count; i++) {
+        if (lines[i].removed)
+            continue;
+        graph->count++;
+        if ((lines[i].opcode == OP_RM || lines[i].opcode == OP_WM) && graph->cell[lines[i].operand & 0x7FF] == -1)
+            graph->cell[lines[i].operand & 0x7FF] = (short)graph->cell_count++;
+    }
+    int n = graph->count > 0 ? graph->count : 1;
+    graph->words = (FLOW_CELLS + graph->cell_count + 63) / 64;
+    graph->order = ALLOCATE(allocator, n * sizeof(int));
+    graph->block = ALLOCATE(allocator, n * sizeof(int));
+    graph->first = ALLOCATE(allocator, (n + 1) * sizeof(int));
+    graph->successors = ALLOCATE(allocator, 2 * n * sizeof(int));
+    graph->predecessors = ALLOCATE(allocator, 2 * n * sizeof(int));
+    graph->pred_first = ALLOCATE(allocator, (n + 1) * sizeof(int));
+    graph->entry = ALLOCATE(allocator, n * sizeof(bool));
+    graph->halts = ALLOCATE(allocator, n * sizeof(bool));
+    graph->sets = ALLOCATE(allocator, (size_t)n * graph->words * sizeof(unsigned long long));
+    graph->scratch = ALLOCATE(allocator, graph->words * sizeof(unsigned long long));
+    graph->live_after = ALLOCATE(allocator, n);
+    SYMTAB labels;
+    if (graph->order == NULL || graph->block == NULL || graph->first == NULL || graph->successors == NULL ||
+        graph->predecessors == NULL || graph->pred_first == NULL || graph->entry == NULL || graph->halts == NULL ||
+        graph->sets == NULL || graph->scratch == NULL || graph->live_after == NULL || !symtab_init(&labels, n, allocator))
+        return false;
+
+    // Blocks, and the position of every label; SYMBOL.line holds the position rather than the line
+    int count = 0;
+    bool ok = true;
+    for (int i = 0; i < program->line_count; i++) {
+        if (!lines[i].removed)
+            graph->order[count++] = i;
+    }
+    for (int p = 0; p < count; p++) {
+        const LINE *line = &program->lines[graph->order[p]];
+        int opcode = lines[graph->order[p]].opcode;
+        int before = p > 0 ? lines[graph->order[p - 1]].opcode : NOT_AN_INSTRUCTION;
+        if (p == 0 || line->label.length != 0 || opcode == NOT_AN_INSTRUCTION || before == NOT_AN_INSTRUCTION ||
+            before == OP_EOP || is_branch(before)) {
+            graph->entry[graph->block_count] = before == NOT_AN_INSTRUCTION;
+            graph->first[graph->block_count++] = p;
+        }
+        graph->block[p] = graph->block_count - 1;
+        bool duplicate;
+        if (line->label.length != 0 && !token_equals(program, line->label, "ORG"))
+            ok = ok && symtab_define(&labels, token_text(program, line->label), line->label.length, 0, p, &duplicate) != -1;
+    }
+    graph->first[graph->block_count] = count;
+
+    for (int b = 0; b < graph->block_count; b++) {
+        int last = graph->first[b + 1] - 1;
+        int opcode = lines[graph->order[last]].opcode;
+        int *next = &graph->successors[2 * b];
+        next[0] = next[1] = FLOW_NONE;
+        if (opcode == NOT_AN_INSTRUCTION || opcode == OP_EOP)
+            continue;
+        int fall = last + 1 < count ? graph->block[last + 1] : FLOW_EXIT;
+        if (!is_branch(opcode)) {
+            next[0] = fall;
+            continue;
+        }
+        const LINE *line = &program->lines[graph->order[last]];
+        int symbol = symtab_find(&labels, token_text(program, line->operand), line->operand.length);
+        next[0] = symbol != -1 && labels.symbols[symbol].defined ? graph->block[labels.symbols[symbol].line] : FLOW_EXIT;
+        if (opcode != OP_BR)
+            next[1] = fall;
+    }
+    symtab_free(&labels);
+
+    // Predecessor lists, counted and then filled in; the sets are not in use yet, so they serve as scratch
+    memset(graph->pred_first, 0, (graph->block_count + 1) * sizeof(int));
+    for (int s = 0; s < 2 * graph->block_count; s++) {
+        if (graph->successors[s] >= 0)
+            graph->pred_first[graph->successors[s] + 1]++;
+    }
+    for (int b = 0; b < graph->block_count; b++)
+        graph->pred_first[b + 1] += graph->pred_first[b];
+    int *filled = (int *)graph->sets;
+    memcpy(filled, graph->pred_first, graph->block_count * sizeof(int));
+    for (int s = 0; s < 2 * graph->block_count; s++) {
+        if (graph->successors[s] >= 0)
+            graph->predecessors[filled[graph->successors[s]]++] = s / 2;
+    }
+
+    // Walk back from the blocks that halt
+    int *work = (int *)graph->sets;
+    int pending = 0;
+    for (int b = 0; b < graph->block_count; b++) {
+        int opcode = lines[graph->order[graph->first[b + 1] - 1]].opcode;
+        graph->halts[b] = opcode == NOT_AN_INSTRUCTION || opcode == OP_EOP ||
+                          graph->successors[2 * b] == FLOW_EXIT || graph->successors[2 * b + 1] == FLOW_EXIT;
+        if (graph->halts[b])
+            work[pending++] = b;
+    }
+    while (pending > 0) {
+        int b = work[--pending];
+        for (int q = graph->pred_first[b]; q < graph->pred_first[b + 1]; q++) {
+            int before = graph->predecessors[q];
+            if (!graph->halts[before]) {
+                graph->halts[before] = true;
+                work[pending++] = before;
+            }
+        }
+    }
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   flow_in
+*   DESCRIPTION :   This function will meet the MBR contents on every way into a block: the cells known to hold
+*                   what MBR holds on all of them. Nothing is known where control can come from outside.
+*   ARGUMENTS   :   const FLOW_GRAPH *graph, int block, unsigned long long *set
+*   RETURNS     :   VOID
+ *==============================================*/
+static void flow_in(const FLOW_GRAPH *graph, int block, unsigned long long *set)
+{
+    memset(set, graph->entry[block] ? 0 : 0xFF, graph->words * sizeof(unsigned long long));
+    for (int q = graph->pred_first[block]; q < graph->pred_first[block + 1]; q++) {
+        const unsigned long long *out = &graph->sets[(size_t)graph->predecessors[q] * graph->words];
+        for (int w = 0; w < graph->words; w++)
+            set[w] &= out[w];
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   flow_loads
+*   DESCRIPTION :   This function will step the MBR contents through a block, removing RM of a cell that MBR is
+*                   known to hold already when remove is set. WM makes MBR and its cell equal; anything else that
+*                   writes MBR ends what was known.
+*   ARGUMENTS   :   const FLOW_GRAPH *graph, int block, DECODED_LINE *lines, const PROGRAM *program,
+*                   unsigned long long *set, bool remove
+*   RETURNS     :   int (loads removed)
+ *==============================================*/
+static int flow_loads(const FLOW_GRAPH *graph, int block, DECODED_LINE *lines, const PROGRAM *program,
+                      unsigned long long *set, bool remove)
+{
+    int removed = 0;
+    for (int p = graph->first[block]; p < graph->first[block + 1]; p++) {
+        DECODED_LINE *line = &lines[graph->order[p]];
+        int bit = FLOW_CELLS + graph->cell[line->operand & 0x7FF];
+        if (line->removed)
+            continue;
+        if (line->opcode == OP_WM)
+            set_bit(set, bit);
+        else if (line->opcode == OP_RM && has_bit(set, bit)) {
+            if (remove && program->lines[graph->order[p]].label.length == 0) {
+                line->removed = true;
+                removed++;
+            }
+        }
+        else if (line->opcode == OP_RM) {
+            memset(set, 0, graph->words * sizeof(unsigned long long));
+            set_bit(set, bit);
+        }
+        else if (line->opcode == NOT_AN_INSTRUCTION || (effect_of(line->opcode).defs & FLOW_MBR) != 0)
+            memset(set, 0, graph->words * sizeof(unsigned long long));
+    }
+    return removed;
+}
+
+/*===============================================
+*   FUNCTION    :   flow_out
+*   DESCRIPTION :   This function will join what is live on every way out of a block. Everything is live at EOP,
+*                   at a barrier, on leaving the code and in a loop that never halts, since the registers and memory
+*                   can be seen there.
+*   ARGUMENTS   :   const FLOW_GRAPH *graph, int block, const DECODED_LINE *lines, unsigned long long *set
+*   RETURNS     :   VOID
+ *==============================================*/
+static void flow_out(const FLOW_GRAPH *graph, int block, const DECODED_LINE *lines, unsigned long long *set)
+{
+    const int *next = &graph->successors[2 * block];
+    int opcode = lines[graph->order[graph->first[block + 1] - 1]].opcode;
+    bool all = !graph->halts[block] || opcode == OP_EOP || opcode == NOT_AN_INSTRUCTION || next[0] == FLOW_EXIT || next[1] == FLOW_EXIT;
+    memset(set, all ? 0xFF : 0, graph->words * sizeof(unsigned long long));
+    for (int s = 0; !all && s < 2; s++) {
+        const unsigned long long *in = next[s] >= 0 ? &graph->sets[(size_t)next[s] * graph->words] : NULL;
+        for (int w = 0; in != NULL && w < graph->words; w++)
+            set[w] |= in[w];
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   flow_live
+*   DESCRIPTION :   This function will step liveness backwards through a block, noting the registers live after
+*                   every position. When remove is set, an instruction that only writes registers and cells that
+*                   are dead is removed, and what it read is not made live. WB, WM, RM and WIB only count as
+*                   pure with a numeric operand, since without one the cell or value is not known.
+*   ARGUMENTS   :   const FLOW_GRAPH *graph, int block, DECODED_LINE *lines, const PROGRAM *program,
+*                   unsigned long long *set, bool remove
+*   RETURNS     :   int (instructions removed)
+ *==============================================*/
+static int flow_live(const FLOW_GRAPH *graph, int block, DECODED_LINE *lines, const PROGRAM *program,
+                     unsigned long long *set, bool remove)
+{
+    int removed = 0;
+    for (int p = graph->first[block + 1] - 1; p >= graph->first[block]; p--) {
+        DECODED_LINE *line = &lines[graph->order[p]];
+        int bit = FLOW_CELLS + graph->cell[line->operand & 0x7FF];
+        if (line->removed)
+            continue;
+        graph->live_after[p] = (unsigned char)(set[0] & (FLOW_MBR | FLOW_ACC | FLOW_IOB | FLOW_FLAGS));
+        if (line->opcode == NOT_AN_INSTRUCTION || line->opcode == OP_EOP) {
+            memset(set, 0xFF, graph->words * sizeof(unsigned long long));
+            continue;
+        }
+        EFFECT effect = effect_of(line->opcode);
+        bool operand = line->opcode == OP_WB || line->opcode == OP_WM || line->opcode == OP_RM || line->opcode == OP_WIB;
+        bool dead = effect.pure && (line->numeric || !operand) && (set[0] & effect.defs) == 0 &&
+                    (line->opcode != OP_WM || !has_bit(set, bit));
+        if (remove && dead && program->lines[graph->order[p]].label.length == 0) {
+            line->removed = true;
+            removed++;
+            continue;
+        }
+        set[0] &= ~(unsigned long long)effect.defs;
+        if (line->opcode == OP_WM)
+            clear_bit(set, bit);
+        set[0] |= effect.uses;
+        if (line->opcode == OP_RM)
+            set_bit(set, bit);
+    }
+    return removed;
+}
+
+/*===============================================
+*   FUNCTION    :   spell_ready
+*   DESCRIPTION :   This function will copy the source text into a buffer with room for rewritten lines, the first
+*                   time it is called, and hand the buffer to the SOURCE, which frees it in source_close().
+*   ARGUMENTS   :   PROGRAM *program, SPELLING *spelling
+*   RETURNS     :   bool (false if there is no room, so nothing can be rewritten)
+ *==============================================*/
+static bool spell_ready(PROGRAM *program, SPELLING *spelling)
+{
+    if (spelling->copied)
+        return spelling->text != NULL;
+    spelling->copied = true;
+    size_t size = program->source.size;
+    if (size > UINT_MAX - SPELLING_ROOM || (spelling->text = malloc(size + SPELLING_ROOM)) == NULL)
+        return false;
+    memcpy(spelling->text, program->source.text, size);
+    memcpy(spelling->text + size, "\nWB WACC BR ", 12);
+    spelling->wb = (TOKEN){ (unsigned int)size + 1, 2 };
+    spelling->wacc = (TOKEN){ (unsigned int)size + 4, 4 };
+    spelling->br = (TOKEN){ (unsigned int)size + 9, 2 };
+    spelling->used = 12;
+    free(program->source.buffer);
+    program->source.buffer = spelling->text;
+    program->source.text = spelling->text;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   rewrite
+*   DESCRIPTION :   This function will turn a line into WB value, WACC, or BR to the label it already names, keeping
+*                   its label and line number.
+*   ARGUMENTS   :   PROGRAM *program, SPELLING *spelling, int index, DECODED_LINE *decoded, int opcode, unsigned char value
+*   RETURNS     :   bool (false if the text could not be copied)
+ *==============================================*/
+static bool rewrite(PROGRAM *program, SPELLING *spelling, int index, DECODED_LINE *decoded, int opcode, unsigned char value)
+{
+    LINE *line = &program->lines[index];
+    if (!spell_ready(program, spelling))
+        return false;
+    TOKEN *spelled = &spelling->values[value];
+    if (opcode == OP_WB && spelled->length == 0) {
+        unsigned int offset = (unsigned int)program->source.size + spelling->used;
+        snprintf(spelling->text + offset, 6, "0x%02x ", value);
+        *spelled = (TOKEN){ offset, 4 };
+        spelling->used += 5;
+    }
+    line->operation = opcode == OP_WB ? spelling->wb : opcode == OP_WACC ? spelling->wacc : spelling->br;
+    if (opcode != OP_BR)
+        line->operand = opcode == OP_WB ? *spelled : (TOKEN){ 0, 0 };
+    decoded->opcode = opcode;
+    decoded->operand = opcode == OP_WB ? value : 0;
+    decoded->numeric = opcode == OP_WB;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   alu
+*   DESCRIPTION :   This function will compute the ACC an ALU instruction leaves, as the simulator does.
+*   ARGUMENTS   :   int opcode, unsigned char acc, unsigned char mbr
+*   RETURNS     :   unsigned char
+ *==============================================*/
+static unsigned char alu(int opcode, unsigned char acc, unsigned char mbr)
+{
+    switch (opcode) {
+    case OP_ADD: return (unsigned char)(acc + mbr);
+    case OP_SUB: return (unsigned char)(acc - mbr);
+    case OP_MUL: return (unsigned char)(acc * mbr);
+    case OP_AND: return acc & mbr;
+    case OP_OR:  return acc | mbr;
+    case OP_XOR: return acc ^ mbr;
+    case OP_NOT: return (unsigned char)~acc;
+    case OP_SHL: return (unsigned char)(acc << 1);
+    default:     return acc >> 1;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   fold_constants
+*   DESCRIPTION :   This function will follow the values of MBR, ACC, IOB and the named cells through one block,
+*                   knowing nothing at its start. An RM or RACC of a known value becomes WB, so the instructions
+*                   that computed it can die; a write of the value already there is removed; an ALU instruction
+*                   whose flags are dead becomes WACC when MBR holds its result, or goes if ACC already does; and
+*                   a conditional branch whose flags are dead becomes BR or goes, as its known outcome says.
+*   ARGUMENTS   :   const FLOW_GRAPH *graph, int block, DECODED_LINE *lines, PROGRAM *program, SPELLING *spelling,
+*                   CONSTANTS *known
+*   RETURNS     :   int (instructions removed or rewritten)
+ *==============================================*/
+static int fold_constants(const FLOW_GRAPH *graph, int block, DECODED_LINE *lines, PROGRAM *program, SPELLING *spelling,
+                          CONSTANTS *known)
+{
+    int changed = 0;
+    known->mbr_known = known->acc_known = known->iob_known = false;
+    known->stamp++;
+    for (int p = graph->first[block]; p < graph->first[block + 1]; p++) {
+        int index = graph->order[p];
+        DECODED_LINE *line = &lines[index];
+        if (line->removed)
+            continue;
+        bool flags_dead = (graph->live_after[p] & FLOW_FLAGS) == 0;
+        int cell = graph->cell[line->operand & 0x7FF];
+        unsigned char value = (unsigned char)line->operand;
+        bool drop = false;
+        switch (line->opcode) {
+        case OP_WB:
+            drop = known->mbr_known && known->mbr == value;
+            known->mbr_known = true;
+            known->mbr = value;
+            break;
+        case OP_WIB:
+            drop = known->iob_known && known->iob == value;
+            known->iob_known = true;
+            known->iob = value;
+            break;
+        case OP_WM:
+            drop = known->mbr_known && known->stamps[cell] == known->stamp && known->cells[cell] == known->mbr;
+            known->stamps[cell] = known->mbr_known ? known->stamp : 0;
+            known->cells[cell] = known->mbr;
+            break;
+        case OP_RM:
+        case OP_RACC: {
+            bool loaded_known = line->opcode == OP_RM ? known->stamps[cell] == known->stamp : known->acc_known;
+            unsigned char loaded = line->opcode == OP_RM ? known->cells[cell] : known->acc;
+            drop = loaded_known && known->mbr_known && known->mbr == loaded;
+            if (loaded_known && !drop && rewrite(program, spelling, index, line, OP_WB, loaded))
+                changed++;
+            known->mbr_known = loaded_known;
+            known->mbr = loaded;
+            break;
+        }
+        case OP_WACC:
+            known->acc_known = known->mbr_known;
+            known->acc = known->mbr;
+            break;
+        case OP_SWAP: {
+            bool mbr_known = known->mbr_known;
+            unsigned char mbr = known->mbr;
+            known->mbr_known = known->iob_known;
+            known->mbr = known->iob;
+            known->iob_known = mbr_known;
+            known->iob = mbr;
+            break;
+        }
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_AND: case OP_OR: case OP_XOR:
+        case OP_NOT: case OP_SHL: case OP_SHR: {
+            bool unary = line->opcode == OP_NOT || line->opcode == OP_SHL || line->opcode == OP_SHR;
+            if (!known->acc_known || !(unary || known->mbr_known)) {
+                known->acc_known = false;
+                break;
+            }
+            unsigned char result = alu(line->opcode, known->acc, known->mbr);
+            drop = flags_dead && result == known->acc;
+            if (!drop && flags_dead && known->mbr_known && known->mbr == result &&
+                rewrite(program, spelling, index, line, OP_WACC, 0))
+                changed++;
+            known->acc = result;
+            break;
+        }
+        case OP_BRE: case OP_BRNE: case OP_BRGT: case OP_BRLT: {
+            if (!flags_dead || !known->acc_known || !known->mbr_known)
+                break;
+            unsigned char acc = known->acc, mbr = known->mbr;
+            bool taken = line->opcode == OP_BRE ? acc == mbr : line->opcode == OP_BRNE ? acc != mbr :
+                         line->opcode == OP_BRGT ? acc > mbr : acc < mbr;
+            drop = !taken;
+            if (taken && rewrite(program, spelling, index, line, OP_BR, 0))
+                changed++;
+            break;
+        }
+        case NOT_AN_INSTRUCTION:
+            known->mbr_known = known->acc_known = known->iob_known = false;
+            known->stamp++;
+            break;
+        }
+        if (drop && program->lines[index].label.length == 0) {
+            line->removed = true;
+            changed++;
+        }
+    }
+    return changed;
+}
+
+/*===============================================
+*   FUNCTION    :   remove_unreachable
+*   DESCRIPTION :   This function will remove the instructions of every block that no path from the start, or from
+*                   after an ORG or a barrier, reaches. Labelled lines stay, as always, and so does a branch to a
+*                   label that is not defined, since it would not assemble.
+*   ARGUMENTS   :   FLOW_GRAPH *graph, DECODED_LINE *lines, const PROGRAM *program
+*   RETURNS     :   int (instructions removed)
+ *==============================================*/
+static int remove_unreachable(FLOW_GRAPH *graph, DECODED_LINE *lines, const PROGRAM *program)
+{
+    // The halting marks and the sets are done with, so they become the reached marks and the work list
+    bool *reached = graph->halts;
+    int *work = (int *)graph->sets;
+    int pending = 0;
+    for (int b = 0; b < graph->block_count; b++) {
+        reached[b] = graph->entry[b];
+        if (reached[b])
+            work[pending++] = b;
+    }
+    while (pending > 0) {
+        int b = work[--pending];
+        for (int s = 0; s < 2; s++) {
+            int next = graph->successors[2 * b + s];
+            if (next >= 0 && !reached[next]) {
+                reached[next] = true;
+                work[pending++] = next;
+            }
+        }
+    }
+
+    int removed = 0;
+    for (int b = 0; b < graph->block_count; b++) {
+        for (int p = graph->first[b]; !reached[b] && p < graph->first[b + 1]; p++) {
+            int index = graph->order[p];
+            // A branch leaves the code only when its label is not defined
+            bool unknown = is_branch(lines[index].opcode) && graph->successors[2 * b] == FLOW_EXIT;
+            if (!lines[index].removed && lines[index].opcode != NOT_AN_INSTRUCTION && !unknown &&
+                program->lines[index].label.length == 0) {
+                lines[index].removed = true;
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+/*===============================================
+*   FUNCTION    :   dataflow
+*   DESCRIPTION :   This function will remove RM loads whose cell MBR already holds on every path to them, then,
+*                   with liveness of MBR, ACC, IOB, the flags and every named memory cell solved over the
+*                   control-flow graph, WM stores that are overwritten before anything reads them and every other
+*                   instruction whose results are all dead. With spelling (-O3), constants are then folded block
+*                   by block, and the blocks nothing reaches any more are removed. Labelled lines always stay.
+*   ARGUMENTS   :   PROGRAM *program, DECODED_LINE *lines, SPELLING *spelling (NULL not to fold constants)
+*   RETURNS     :   int (instructions removed or rewritten)
+ *==============================================*/
+static int dataflow(PROGRAM *program, DECODED_LINE *lines, SPELLING *spelling)
+{
+    FLOW_GRAPH graph;
+    int removed = 0;
+    if (!build_graph(program, lines, &graph)) {
+        free_graph(program->allocator, &graph);
+        return 0;
+    }
+    size_t bytes = graph.words * sizeof(unsigned long long);
+
+    // Forward: which cells equal MBR at the end of every block, starting from "all" and shrinking
+    memset(graph.sets, 0xFF, graph.block_count * bytes);
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (int b = 0; b < graph.block_count; b++) {
+            flow_in(&graph, b, graph.scratch);
+            flow_loads(&graph, b, lines, program, graph.scratch, false);
+            if (memcmp(graph.scratch, &graph.sets[(size_t)b * graph.words], bytes) != 0) {
+                memcpy(&graph.sets[(size_t)b * graph.words], graph.scratch, bytes);
+                changed = true;
+            }
+        }
+    }
+    // Every block is walked from the same solution, so the sets cannot change while loads are removed
+    for (int b = 0; b < graph.block_count; b++) {
+        flow_in(&graph, b, graph.scratch);
+        removed += flow_loads(&graph, b, lines, program, graph.scratch, true);
+    }
+
+    // Backward: what is live at the start of every block, starting from nothing and growing
+    memset(graph.sets, 0, graph.block_count * bytes);
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (int b = graph.block_count - 1; b >= 0; b--) {
+            flow_out(&graph, b, lines, graph.scratch);
+            flow_live(&graph, b, lines, program, graph.scratch, false);
+            if (memcmp(graph.scratch, &graph.sets[(size_t)b * graph.words], bytes) != 0) {
+                memcpy(&graph.sets[(size_t)b * graph.words], graph.scratch, bytes);
+                changed = true;
+            }
+        }
+    }
+    for (int b = 0; b < graph.block_count; b++) {
+        flow_out(&graph, b, lines, graph.scratch);
+        removed += flow_live(&graph, b, lines, program, graph.scratch, true);
+    }
+
+    // Folding goes by the liveness just found; what it leaves dead is removed on the next call
+    if (spelling != NULL) {
+        CONSTANTS known = { 0 };
+        int cells = graph.cell_count > 0 ? graph.cell_count : 1;
+        known.cells = ALLOCATE(program->allocator, cells);
+        known.stamps = ALLOCATE(program->allocator, cells * sizeof(int));
+        if (known.stamps != NULL)
+            memset(known.stamps, 0, cells * sizeof(int));
+        for (int b = 0; known.cells != NULL && known.stamps != NULL && b < graph.block_count; b++)
+            removed += fold_constants(&graph, b, lines, program, spelling, &known);
+        if (known.cells != NULL)
+            RELEASE(program->allocator, known.cells);
+        if (known.stamps != NULL)
+            RELEASE(program->allocator, known.stamps);
+    }
+    if (spelling != NULL)
+        removed += remove_unreachable(&graph, lines, program);
+    free_graph(program->allocator, &graph);
+    return removed;
+}
+
+/*===============================================
+*   FUNCTION    :   optimize_program
+*   DESCRIPTION :   This function will run the passes of the given -O level over the lines of a program that
+*                   assemble_program() has turned into code without errors, remove the instructions they found
+*                   to be redundant, and replace code with the encoding of what is left. Every line is known to
+*                   assemble, so the passes can take each one as it decodes. If memory runs out, the passes stop
+*                   where they are, and if the new encoding cannot be made, code is left as it was.
+*   ARGUMENTS   :   PROGRAM *program, int level, MACHINE_CODE *code, DIAGNOSTICS *diagnostics
+*   RETURNS     :   int (instructions removed)
+ *==============================================*/
+int optimize_program(PROGRAM *program, int level, MACHINE_CODE *code, DIAGNOSTICS *diagnostics)
+{
+    if (level < OPTIMIZE_PEEPHOLE || program->line_count == 0)
+        return 0;
+
+    // Every ORG starts a segment, and there is one before the first
+    const TRACS_ALLOCATOR *allocator = program->allocator;
+    DECODED_LINE *lines = ALLOCATE(allocator, program->line_count * sizeof(DECODED_LINE));
+    SEGMENT *segments = ALLOCATE(allocator, (program->line_count + 1) * sizeof(SEGMENT));
+    bool decoded = lines != NULL && segments != NULL && decode_lines(program, lines, segments, diagnostics);
+    int changes = decoded ? peephole(program, lines) : 0;
+
+    // What one pass changes can leave more for the other, so they take turns until neither finds anything
+    SPELLING spelling;
+    memset(&spelling, 0, sizeof(spelling));
+    for (int found = decoded; level >= OPTIMIZE_DATAFLOW && found != 0; ) {
+        found = dataflow(program, lines, level >= OPTIMIZE_CONSTANTS ? &spelling : NULL);
+        if (found != 0)
+            found += peephole(program, lines);
+        changes += found;
+    }
+
+    int removed = 0;
+    if (decoded) {
+        int kept = 0;
+        for (int i = 0; i < program->line_count; i++) {
+            if (!lines[i].removed)
+                program->lines[kept++] = program->lines[i];
+        }
+        removed = program->line_count - kept;
+        program->line_count = kept;
+    }
+    if (lines != NULL)
+        RELEASE(allocator, lines);
+    if (segments != NULL)
+        RELEASE(allocator, segments);
+
+    // The first encoding reported everything there is to say; what is left assembles the same way
+    if (changes != 0) {
+        MACHINE_CODE optimized;
+        DIAGNOSTICS scratch;
+        diagnostics_init(&scratch, allocator);
+        if (assemble_program(program, &optimized, &scratch)) {
+            freeMachineCode(code);
+            *code = optimized;
+        }
+        diagnostics_free(&scratch);
+    }
+    return removed;
+}
@@ -0,0 +1,31 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include "assembler.h"
+
+#define OPTIMIZE_NONE       0
+#define OPTIMIZE_PEEPHOLE   1       // Table of rewrites on neighbouring instructions
+#define OPTIMIZE_DATAFLOW   2       // Also dead stores and reloads, found over the control-flow graph
+#define OPTIMIZE_CONSTANTS  3       // Also values known at assembly time, folded into WB
+#define OPTIMIZE_MAX        OPTIMIZE_CONSTANTS
+
+typedef enum peepholeAction {
+    DROP_FIRST,             // The first instruction's result is replaced before anything reads it
+    DROP_SECOND             // The second instruction would leave everything as it already is
+} PEEPHOLE_ACTION;
+
+typedef struct peepholeRule {
+    unsigned char first;    // Opcode of the first instruction
+    unsigned char second;   // Opcode of the instruction right after it
+    bool same_operand;      // Only when both name the same address or value
+    PEEPHOLE_ACTION action;
+} PEEPHOLE_RULE;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+int optimize_program(PROGRAM *program, int level, MACHINE_CODE *code, DIAGNOSTICS *diagnostics);
+
+#endif
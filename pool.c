@@ -0,0 +1,189 @@
+/*======================================================================================================
+* FILE        : pool.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains a work-stealing thread pool for running independent jobs (one source
+*               file each) on every core. Each worker starts with an even share of the task indices and
+*               works from the back of its own range; an idle worker steals the front half of another
+*               worker's remaining range, so a few slow jobs do not leave the other cores waiting.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created, used by batch assembly in main.c.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdlib.h>
+#include <pthread.h>
+#include "pool.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+typedef struct deque {
+    pthread_mutex_t lock;
+    int begin;              // Thieves take from here
+    int end;                // The owner takes from here
+} DEQUE;
+
+typedef struct pool {
+    DEQUE *deques;
+    int workers;
+    POOL_TASK task;
+    void *context;
+} POOL;
+
+typedef struct worker {
+    POOL *pool;
+    int id;
+    pthread_t thread;
+} WORKER;
+
+/*===============================================
+*   FUNCTION    :   pool_default_workers
+*   DESCRIPTION :   This function will return the number of online processors.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   int
+ *==============================================*/
+int pool_default_workers(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
+
+/*===============================================
+*   FUNCTION    :   pop
+*   DESCRIPTION :   This function will take the last task of the worker's own range.
+*   ARGUMENTS   :   DEQUE *deque
+*   RETURNS     :   int (-1 if the range is empty)
+ *==============================================*/
+static int pop(DEQUE *deque)
+{
+    int index = -1;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->begin < deque->end)
+        index = --deque->end;
+    pthread_mutex_unlock(&deque->lock);
+    return index;
+}
+
+/*===============================================
+*   FUNCTION    :   steal
+*   DESCRIPTION :   This function will move the front half of a victim's range into the thief's (empty) range
+*                   and return one task of it to run right away.
+*   ARGUMENTS   :   DEQUE *victim, DEQUE *thief
+*   RETURNS     :   int (-1 if the victim had nothing left)
+ *==============================================*/
+static int steal(DEQUE *victim, DEQUE *thief)
+{
+    int begin, end;
+    pthread_mutex_lock(&victim->lock);
+    int available = victim->end - victim->begin;
+    if (available <= 0) {
+        pthread_mutex_unlock(&victim->lock);
+        return -1;
+    }
+    begin = victim->begin;
+    end = begin + (available + 1) / 2;
+    victim->begin = end;
+    pthread_mutex_unlock(&victim->lock);
+
+    pthread_mutex_lock(&thief->lock);
+    thief->begin = begin;
+    thief->end = end - 1;
+    pthread_mutex_unlock(&thief->lock);
+    return end - 1;
+}
+
+/*===============================================
+*   FUNCTION    :   worker_main
+*   DESCRIPTION :   This function will run tasks until every range in the pool is empty. No task adds new
+*                   work, so a full sweep of empty ranges means the pool is done.
+*   ARGUMENTS   :   void *argument (WORKER *)
+*   RETURNS     :   void *
+ *==============================================*/
+static void *worker_main(void *argument)
+{
+    WORKER *worker = argument;
+    POOL *pool = worker->pool;
+    DEQUE *own = &pool->deques[worker->id];
+
+    for (;;) {
+        int index = pop(own);
+        for (int i = 1; index == -1 && i < pool->workers; i++)
+            index = steal(&pool->deques[(worker->id + i) % pool->workers], own);
+        if (index == -1)
+            break;
+        pool->task(index, worker->id, pool->context);
+    }
+    return NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   pool_run
+*   DESCRIPTION :   This function will run task(0 .. task_count-1) on the given number of threads and wait for
+*                   all of them. With a single worker the tasks run on the calling thread.
+*   ARGUMENTS   :   int task_count, int workers, POOL_TASK task, void *context
+*   RETURNS     :   bool (false if the threads could not be started)
+ *==============================================*/
+bool pool_run(int task_count, int workers, POOL_TASK task, void *context)
+{
+    if (workers > task_count)
+        workers = task_count;
+    if (workers <= 1) {
+        for (int i = 0; i < task_count; i++)
+            task(i, 0, context);
+        return true;
+    }
+
+    POOL pool = { NULL, workers, task, context };
+    pool.deques = malloc(workers * sizeof(DEQUE));
+    WORKER *threads = malloc(workers * sizeof(WORKER));
+    if (pool.deques == NULL || threads == NULL) {
+        free(pool.deques);
+        free(threads);
+        return false;
+    }
+
+    // Even contiguous shares to start with; stealing evens out the rest
+    for (int i = 0; i < workers; i++) {
+        pthread_mutex_init(&pool.deques[i].lock, NULL);
+        pool.deques[i].begin = (int)((long long)task_count * i / workers);
+        pool.deques[i].end = (int)((long long)task_count * (i + 1) / workers);
+    }
+
+    // Worker 0 is the calling thread
+    int started = 1;
+    for (int i = 0; i < workers; i++) {
+        threads[i].pool = &pool;
+        threads[i].id = i;
+    }
+    for (int i = 1; i < workers; i++) {
+        if (pthread_create(&threads[i].thread, NULL, worker_main, &threads[i]) != 0)
+            break;
+        started++;
+    }
+    worker_main(&threads[0]);
+    for (int i = 1; i < started; i++)
+        pthread_join(threads[i].thread, NULL);
+
+    for (int i = 0; i < workers; i++)
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    free(pool.deques);
+    free(threads);
+    return true;
+}
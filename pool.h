@@ -0,0 +1,17 @@
+#ifndef POOL_H
+#define POOL_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdbool.h>
+
+// Runs task number index on the given worker (0 .. workers-1)
+typedef void (*POOL_TASK)(int index, int worker, void *context);
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+int pool_default_workers(void);
+bool pool_run(int task_count, int workers, POOL_TASK task, void *context);
+
+#endif
@@ -0,0 +1,201 @@
+/*======================================================================================================
+* FILE        : simulator.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the TRACS instruction-set simulator. It runs the assembler's machine
+*               code directly, so a program can be tested without generating and compiling the
+*               MainMemory() statements.
+*
+*               Every instruction is two bytes: the top five bits of the first byte are the opcode and
+*               the remaining three bits plus the second byte form the 11-bit operand. Code and data
+*               share main memory, so WM can overwrite instructions.
+*               Conditional branches compare ACC with MBR as unsigned bytes. SWAP exchanges MBR and IOB.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <string.h>
+#include "opcodes.h"
+#include "simulator.h"
+
+/*===============================================
+*   FUNCTION    :   sim_reset
+*   DESCRIPTION :   This function will clear memory, registers and flags.
+*   ARGUMENTS   :   MACHINE *machine
+*   RETURNS     :   VOID
+ *==============================================*/
+void sim_reset(MACHINE *machine)
+{
+    memset(machine, 0, sizeof(*machine));
+    machine->status = SIM_RUNNING;
+}
+
+/*===============================================
+*   FUNCTION    :   sim_load
+*   DESCRIPTION :   This function will reset the machine, copy the machine code into main memory and point the
+*                   PC at the first instruction.
+*   ARGUMENTS   :   MACHINE *machine, const MACHINE_CODE *code
+*   RETURNS     :   bool (false if the code does not fit in memory)
+ *==============================================*/
+bool sim_load(MACHINE *machine, const MACHINE_CODE *code)
+{
+    sim_reset(machine);
+    if (!buildMemoryImage(code, machine->memory, NULL))
+        return false;
+    machine->pc = code->count > 0 ? code->bytes[0].address : 0;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   set_flags
+*   DESCRIPTION :   This function will set ZERO and SIGN from an 8-bit result, plus the given CARRY/OVERFLOW.
+*   ARGUMENTS   :   MACHINE *machine, unsigned char result, bool carry, bool overflow
+*   RETURNS     :   VOID
+ *==============================================*/
+static void set_flags(MACHINE *machine, unsigned char result, bool carry, bool overflow)
+{
+    machine->flags = (result == 0 ? FLAG_ZERO : 0) | (carry ? FLAG_CARRY : 0) |
+                     (result & 0x80 ? FLAG_SIGN : 0) | (overflow ? FLAG_OVERFLOW : 0);
+}
+
+/*===============================================
+*   FUNCTION    :   compare
+*   DESCRIPTION :   This function will compare ACC with MBR (ACC - MBR) for a conditional branch and set the flags.
+*   ARGUMENTS   :   MACHINE *machine
+*   RETURNS     :   VOID
+ *==============================================*/
+static void compare(MACHINE *machine)
+{
+    unsigned char result = machine->acc - machine->mbr;
+    bool overflow = ((machine->acc ^ machine->mbr) & (machine->acc ^ result) & 0x80) != 0;
+    set_flags(machine, result, machine->acc < machine->mbr, overflow);
+}
+
+/*===============================================
+*   FUNCTION    :   sim_step
+*   DESCRIPTION :   This function will fetch, decode and execute one instruction.
+*   ARGUMENTS   :   MACHINE *machine
+*   RETURNS     :   SIM_STATUS
+ *==============================================*/
+SIM_STATUS sim_step(MACHINE *machine)
+{
+    if (machine->status != SIM_RUNNING)
+        return machine->status;
+    if (machine->pc + 1 >= TRACS_MEMORY_SIZE)
+        return machine->status = SIM_PC_OUT_OF_RANGE;
+
+    unsigned char high = machine->memory[machine->pc];
+    unsigned int operand = ((high & 0x07) << 8) | machine->memory[machine->pc + 1];
+    unsigned char imm = operand & 0xFF;
+    unsigned int acc = machine->acc;
+    unsigned int mbr = machine->mbr;
+    unsigned char result;
+    machine->pc += 2;
+    machine->steps++;
+
+    switch (high & OPCODE_MASK) {
+    case OP_WB: machine->mbr = imm; break;
+    case OP_WM: machine->memory[operand] = machine->mbr; break;
+    case OP_RM: machine->mbr = machine->memory[operand]; break;
+    case OP_WACC: machine->acc = machine->mbr; break;
+    case OP_WIB: machine->iob = imm; break;
+    case OP_WIO: machine->io[operand] = machine->iob; break;
+    case OP_RACC: machine->mbr = machine->acc; break;
+    case OP_SWAP: machine->mbr = machine->iob; machine->iob = mbr; break;
+    case OP_ADD:
+        result = acc + mbr;
+        set_flags(machine, result, acc + mbr > 0xFF, (~(acc ^ mbr) & (acc ^ result) & 0x80) != 0);
+        machine->acc = result;
+        break;
+    case OP_SUB:
+        result = acc - mbr;
+        set_flags(machine, result, acc < mbr, ((acc ^ mbr) & (acc ^ result) & 0x80) != 0);
+        machine->acc = result;
+        break;
+    case OP_MUL:
+        result = acc * mbr;
+        set_flags(machine, result, acc * mbr > 0xFF, false);
+        machine->acc = result;
+        break;
+    case OP_AND: machine->acc &= mbr; set_flags(machine, machine->acc, false, false); break;
+    case OP_OR: machine->acc |= mbr; set_flags(machine, machine->acc, false, false); break;
+    case OP_XOR: machine->acc ^= mbr; set_flags(machine, machine->acc, false, false); break;
+    case OP_NOT: machine->acc = ~acc; set_flags(machine, machine->acc, false, false); break;
+    case OP_SHL: machine->acc = acc << 1; set_flags(machine, machine->acc, acc & 0x80, false); break;
+    case OP_SHR: machine->acc = acc >> 1; set_flags(machine, machine->acc, acc & 0x01, false); break;
+    case OP_BR: machine->pc = operand; break;
+    case OP_BRE: compare(machine); if (acc == mbr) machine->pc = operand; break;
+    case OP_BRNE: compare(machine); if (acc != mbr) machine->pc = operand; break;
+    case OP_BRGT: compare(machine); if (acc > mbr) machine->pc = operand; break;
+    case OP_BRLT: compare(machine); if (acc < mbr) machine->pc = operand; break;
+    case OP_EOP: return machine->status = SIM_HALTED;
+    default:
+        machine->pc -= 2;
+        machine->steps--;
+        return machine->status = SIM_INVALID_OPCODE;
+    }
+    return SIM_RUNNING;
+}
+
+/*===============================================
+*   FUNCTION    :   sim_run
+*   DESCRIPTION :   This function will run until EOP, a fault, or step_limit instructions (0 for no limit).
+*   ARGUMENTS   :   MACHINE *machine, unsigned long long step_limit
+*   RETURNS     :   SIM_STATUS
+ *==============================================*/
+SIM_STATUS sim_run(MACHINE *machine, unsigned long long step_limit)
+{
+    while (sim_step(machine) == SIM_RUNNING) {
+        if (step_limit != 0 && machine->steps >= step_limit)
+            return machine->status = SIM_STEP_LIMIT;
+    }
+    return machine->status;
+}
+
+/*===============================================
+*   FUNCTION    :   sim_status_name
+*   DESCRIPTION :   This function will describe a status.
+*   ARGUMENTS   :   SIM_STATUS status
+*   RETURNS     :   const char *
+ *==============================================*/
+const char *sim_status_name(SIM_STATUS status)
+{
+    switch (status) {
+    case SIM_RUNNING:           return "running";
+    case SIM_HALTED:            return "halted at EOP";
+    case SIM_INVALID_OPCODE:    return "invalid opcode";
+    case SIM_PC_OUT_OF_RANGE:   return "PC out of range";
+    case SIM_STEP_LIMIT:        return "step limit reached";
+    }
+    return "unknown";
+}
+
+/*===============================================
+*   FUNCTION    :   sim_print_state
+*   DESCRIPTION :   This function will print the registers, flags and every memory location that differs from
+*                   initial (the image the program was loaded from; NULL prints no memory).
+*   ARGUMENTS   :   const MACHINE *machine, const unsigned char *initial, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void sim_print_state(const MACHINE *machine, const unsigned char *initial, FILE *file)
+{
+    fprintf(file, "Status: %s after %llu instructions, PC = 0x%03x\n", sim_status_name(machine->status), machine->steps, machine->pc);
+    fprintf(file, "ACC = 0x%02x; MBR = 0x%02x; IOB = 0x%02x; FLAGS = %c%c%c%c\n", machine->acc, machine->mbr, machine->iob,
+            machine->flags & FLAG_ZERO ? 'Z' : '-', machine->flags & FLAG_CARRY ? 'C' : '-',
+            machine->flags & FLAG_SIGN ? 'S' : '-', machine->flags & FLAG_OVERFLOW ? 'O' : '-');
+    if (initial == NULL)
+        return;
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+        if (machine->memory[address] != initial[address])
+            fprintf(file, "MEM[0x%03x] = 0x%02x\n", address, machine->memory[address]);
+    }
+    for (unsigned int address = 0; address < TRACS_MEMORY_SIZE; address++) {
+        if (machine->io[address] != 0)
+            fprintf(file, "IO[0x%03x] = 0x%02x\n", address, machine->io[address]);
+    }
+}
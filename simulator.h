@@ -0,0 +1,48 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdio.h>
+#include <stdbool.h>
+#include "translation.h"
+
+#define SIM_DEFAULT_STEP_LIMIT 1000000ULL
+
+// ALU flags, set by ADD/SUB/MUL/AND/OR/NOT/XOR/SHL/SHR and by the compare of a conditional branch
+#define FLAG_ZERO       0x01
+#define FLAG_CARRY      0x02    // Carry out of ADD/MUL/SHL/SHR, borrow of SUB and compares
+#define FLAG_SIGN       0x04
+#define FLAG_OVERFLOW   0x08
+
+typedef enum simStatus {
+    SIM_RUNNING,
+    SIM_HALTED,             // Reached EOP
+    SIM_INVALID_OPCODE,
+    SIM_PC_OUT_OF_RANGE,
+    SIM_STEP_LIMIT
+} SIM_STATUS;
+
+typedef struct tracs_machine {
+    unsigned char memory[TRACS_MEMORY_SIZE];    // Main memory, holds both code and data
+    unsigned char io[TRACS_MEMORY_SIZE];        // I/O space written by WIO
+    unsigned char mbr;
+    unsigned char acc;
+    unsigned char iob;
+    unsigned char flags;
+    unsigned int pc;
+    unsigned long long steps;
+    SIM_STATUS status;
+} MACHINE;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void sim_reset(MACHINE *machine);
+bool sim_load(MACHINE *machine, const MACHINE_CODE *code);
+SIM_STATUS sim_step(MACHINE *machine);
+SIM_STATUS sim_run(MACHINE *machine, unsigned long long step_limit);
+const char *sim_status_name(SIM_STATUS status);
+void sim_print_state(const MACHINE *machine, const unsigned char *initial, FILE *file);
+
+#endif
@@ -0,0 +1,141 @@
+/*======================================================================================================
+* FILE        : source.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the input layer of the assembler. Regular files are memory-mapped so the
+*               lexer can point its tokens straight into the mapping; pipes and stdin ("-") are streamed
+*               into a growing heap buffer instead.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created, replaces the fread copy in process_file().
+*   16 October, 2026: V1.1 - Failures are returned through errno instead of printed.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include "source.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*===============================================
+*   FUNCTION    :   read_stream
+*   DESCRIPTION :   This function will read a stream to its end into a growing heap buffer.
+*   ARGUMENTS   :   FILE *fp, SOURCE *source
+*   RETURNS     :   bool
+ *==============================================*/
+static bool read_stream(FILE *fp, SOURCE *source)
+{
+    size_t capacity = 0;
+    size_t read;
+    do {
+        if (source->size == capacity) {
+            capacity = capacity ? capacity * 2 : 65536;
+            char *buffer = realloc(source->buffer, capacity);
+            if (buffer == NULL) {
+                errno = ENOMEM;
+                return false;
+            }
+            source->buffer = buffer;
+        }
+        read = fread(source->buffer + source->size, 1, capacity - source->size, fp);
+        source->size += read;
+    } while (read > 0);
+    source->text = source->buffer;
+    if (ferror(fp)) {
+        if (errno == 0)
+            errno = EIO;
+        return false;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   source_open
+*   DESCRIPTION :   This function will make the contents of a file available in memory. "-" reads stdin.
+*                   On failure errno says why.
+*   ARGUMENTS   :   const char *filename, SOURCE *source
+*   RETURNS     :   bool
+ *==============================================*/
+bool source_open(const char *filename, SOURCE *source)
+{
+    memset(source, 0, sizeof(*source));
+    source->text = "";
+
+    if (strcmp(filename, "-") == 0) {
+        if (!read_stream(stdin, source)) {
+            int error = errno;
+            source_close(source);
+            errno = error;
+            return false;
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            close(fd);
+            madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+            source->mapping = mapping;
+            source->mapping_size = (size_t)st.st_size;
+            source->text = mapping;
+            source->size = (size_t)st.st_size;
+            return true;
+        }
+    }
+    // Not mappable (FIFO, character device, empty file): stream it instead
+    FILE *fp = fdopen(fd, "rb");
+    if (fp == NULL) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+#else
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL)
+        return false;
+#endif
+    bool ok = read_stream(fp, source);
+    fclose(fp);
+    if (!ok) {
+        int error = errno;
+        source_close(source);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   source_close
+*   DESCRIPTION :   This function will unmap or free the source text.
+*   ARGUMENTS   :   SOURCE *source
+*   RETURNS     :   VOID
+ *==============================================*/
+void source_close(SOURCE *source)
+{
+#ifndef _WIN32
+    if (source->mapping != NULL)
+        munmap(source->mapping, source->mapping_size);
+#endif
+    free(source->buffer);
+    memset(source, 0, sizeof(*source));
+    source->text = "";
+}
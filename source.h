@@ -0,0 +1,23 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct source {
+    const char *text;       // Source bytes, not NUL-terminated
+    size_t size;
+    void *mapping;          // Memory-mapped view of the file, NULL if the text was read into buffer
+    size_t mapping_size;
+    char *buffer;           // Heap copy for pipes, terminals and platforms without mmap
+} SOURCE;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+bool source_open(const char *filename, SOURCE *source);
+void source_close(SOURCE *source);
+
+#endif
@@ -0,0 +1,271 @@
+/*======================================================================================================
+* FILE        : stats.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the --stats instrumentation: wall time, lines, bytes, allocations and
+*               peak resident memory of each assembler phase, printed as text or JSON.
+*
+*               Allocations are counted by a TRACS_ALLOCATOR that wraps the real one, so only memory the
+*               assembler takes through its allocator is seen; the source text is mapped or read by
+*               source.c and shows up in the peak RSS only.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - stats_end() also records a --trace span.
+*   16 October, 2026: V1.2 - The counting allocator wraps any backing allocator, such as a worker's arena.
+*   16 October, 2026: V1.3 - Added the optimize phase, left out of the text table when -O was not given.
+*   16 October, 2026: V1.4 - The optimize phase comes after encode, where it now runs.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <string.h>
+#include "allocator.h"
+#include "stats.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+static const char *phaseNames[STATS_PHASES] = { "read", "tokenize", "encode", "optimize", "output" };
+
+/*===============================================
+*   FUNCTION    :   stats_now
+*   DESCRIPTION :   This function will read a monotonic clock.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   double (seconds)
+ *==============================================*/
+double stats_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+#endif
+}
+
+/*===============================================
+*   FUNCTION    :   peak_rss_kb
+*   DESCRIPTION :   This function will read the peak resident set size of the process.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   long (KB, 0 where the platform does not report it)
+ *==============================================*/
+static long peak_rss_kb(void)
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;     // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static void *counted_allocate(void *context, size_t size)
+{
+    STATS *stats = context;
+    stats->allocations++;
+    stats->allocated_bytes += size;
+    return stats->backing->allocate(stats->backing->context, size);
+}
+
+static void *counted_reallocate(void *context, void *pointer, size_t old_size, size_t size)
+{
+    STATS *stats = context;
+    stats->allocations++;
+    stats->allocated_bytes += size > old_size ? size - old_size : 0;
+    return stats->backing->reallocate(stats->backing->context, pointer, old_size, size);
+}
+
+static void counted_release(void *context, void *pointer)
+{
+    STATS *stats = context;
+    stats->backing->release(stats->backing->context, pointer);
+}
+
+/*===============================================
+*   FUNCTION    :   stats_init
+*   DESCRIPTION :   This function will clear the counters and set up the counting allocator over heap_allocator.
+*   ARGUMENTS   :   STATS *stats
+*   RETURNS     :   VOID
+ *==============================================*/
+void stats_init(STATS *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->allocator.allocate = counted_allocate;
+    stats->allocator.reallocate = counted_reallocate;
+    stats->allocator.release = counted_release;
+    stats->allocator.context = stats;
+    stats->backing = &heap_allocator;
+}
+
+/*===============================================
+*   FUNCTION    :   stats_begin
+*   DESCRIPTION :   This function will start timing a phase. A NULL stats does nothing.
+*   ARGUMENTS   :   STATS *stats, STATS_PHASE phase
+*   RETURNS     :   VOID
+ *==============================================*/
+void stats_begin(STATS *stats, STATS_PHASE phase)
+{
+    if (stats == NULL)
+        return;
+    stats->phase = phase;
+    stats->startAllocations = stats->allocations;
+    stats->startBytes = stats->allocated_bytes;
+    stats->started = stats_now();
+}
+
+/*===============================================
+*   FUNCTION    :   stats_end
+*   DESCRIPTION :   This function will add the time and allocations since stats_begin() to the phase, along with
+*                   the lines and bytes it handled, and trace it as a span. A NULL stats does nothing.
+*   ARGUMENTS   :   STATS *stats, unsigned long long lines, unsigned long long bytes
+*   RETURNS     :   VOID
+ *==============================================*/
+void stats_end(STATS *stats, unsigned long long lines, unsigned long long bytes)
+{
+    if (stats == NULL)
+        return;
+    double now = stats_now();
+    STATS_RECORD *record = &stats->phases[stats->phase];
+    record->seconds += now - stats->started;
+    record->lines += lines;
+    record->bytes += bytes;
+    record->allocations += stats->allocations - stats->startAllocations;
+    record->allocated_bytes += stats->allocated_bytes - stats->startBytes;
+    record->peak_rss_kb = peak_rss_kb();
+    trace_span(stats->trace, phaseNames[stats->phase], stats->input, stats->thread, stats->started, now);
+}
+
+/*===============================================
+*   FUNCTION    :   stats_add
+*   DESCRIPTION :   This function will add the phases of one assembly to a running total. Peak RSS is
+*                   process-wide, so the total keeps the highest.
+*   ARGUMENTS   :   STATS *total, const STATS *stats
+*   RETURNS     :   VOID
+ *==============================================*/
+void stats_add(STATS *total, const STATS *stats)
+{
+    for (int phase = 0; phase < STATS_PHASES; phase++) {
+        STATS_RECORD *sum = &total->phases[phase];
+        const STATS_RECORD *record = &stats->phases[phase];
+        sum->seconds += record->seconds;
+        sum->lines += record->lines;
+        sum->bytes += record->bytes;
+        sum->allocations += record->allocations;
+        sum->allocated_bytes += record->allocated_bytes;
+        if (record->peak_rss_kb > sum->peak_rss_kb)
+            sum->peak_rss_kb = record->peak_rss_kb;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   stats_phase_name
+*   DESCRIPTION :   This function will name a phase.
+*   ARGUMENTS   :   STATS_PHASE phase
+*   RETURNS     :   const char *
+ *==============================================*/
+const char *stats_phase_name(STATS_PHASE phase)
+{
+    return phase < STATS_PHASES ? phaseNames[phase] : "unknown";
+}
+
+/*===============================================
+*   FUNCTION    :   rate
+*   DESCRIPTION :   This function will divide a count by a time, 0 when no time was measured.
+*   ARGUMENTS   :   unsigned long long count, double seconds
+*   RETURNS     :   double
+ *==============================================*/
+static double rate(unsigned long long count, double seconds)
+{
+    return seconds > 0 ? count / seconds : 0;
+}
+
+/*===============================================
+*   FUNCTION    :   stats_print
+*   DESCRIPTION :   This function will print one line per phase and a total. The optimize phase is only
+*                   shown if it ran; the JSON always has every phase, so its shape does not change.
+*   ARGUMENTS   :   const STATS *stats, const char *name, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void stats_print(const STATS *stats, const char *name, FILE *file)
+{
+    STATS_RECORD total = { 0 };
+    fprintf(file, "%s:\n", name);
+    fprintf(file, "  %-9s %12s %12s %14s %14s %8s %12s %10s\n",
+            "phase", "ms", "lines", "lines/s", "MB/s", "allocs", "alloc KB", "peak KB");
+    for (int phase = 0; phase < STATS_PHASES; phase++) {
+        const STATS_RECORD *record = &stats->phases[phase];
+        if (phase == STATS_OPTIMIZE && record->lines == 0 && record->seconds == 0)
+            continue;
+        fprintf(file, "  %-9s %12.3f %12llu %14.0f %14.2f %8llu %12.1f %10ld\n", phaseNames[phase],
+                record->seconds * 1e3, record->lines, rate(record->lines, record->seconds),
+                rate(record->bytes, record->seconds) / 1e6, record->allocations, record->allocated_bytes / 1024.0,
+                record->peak_rss_kb);
+        total.seconds += record->seconds;
+        total.allocations += record->allocations;
+        total.allocated_bytes += record->allocated_bytes;
+        if (record->peak_rss_kb > total.peak_rss_kb)
+            total.peak_rss_kb = record->peak_rss_kb;
+    }
+    fprintf(file, "  %-9s %12.3f %12s %14s %14s %8llu %12.1f %10ld\n", "total", total.seconds * 1e3, "", "", "",
+            total.allocations, total.allocated_bytes / 1024.0, total.peak_rss_kb);
+}
+
+/*===============================================
+*   FUNCTION    :   print_json_string
+*   DESCRIPTION :   This function will print a string as a quoted JSON string.
+*   ARGUMENTS   :   const char *text, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void print_json_string(const char *text, FILE *file)
+{
+    fputc('"', file);
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\')
+            fprintf(file, "\\%c", *p);
+        else if (*p < 0x20)
+            fprintf(file, "\\u%04x", *p);
+        else
+            fputc(*p, file);
+    }
+    fputc('"', file);
+}
+
+/*===============================================
+*   FUNCTION    :   stats_print_json
+*   DESCRIPTION :   This function will print the phases as one JSON object (no trailing newline), so the caller
+*                   can put several of them in an array.
+*   ARGUMENTS   :   const STATS *stats, const char *name, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void stats_print_json(const STATS *stats, const char *name, FILE *file)
+{
+    fprintf(file, "{\"input\":");
+    print_json_string(name, file);
+    fprintf(file, ",\"phases\":[");
+    for (int phase = 0; phase < STATS_PHASES; phase++) {
+        const STATS_RECORD *record = &stats->phases[phase];
+        fprintf(file, "%s{\"name\":\"%s\",\"seconds\":%.9f,\"lines\":%llu,\"bytes\":%llu,\"lines_per_second\":%.1f,"
+                "\"bytes_per_second\":%.1f,\"allocations\":%llu,\"allocated_bytes\":%llu,\"peak_rss_kb\":%ld}",
+                phase > 0 ? "," : "", phaseNames[phase], record->seconds, record->lines, record->bytes,
+                rate(record->lines, record->seconds), rate(record->bytes, record->seconds), record->allocations,
+                record->allocated_bytes, record->peak_rss_kb);
+    }
+    fprintf(file, "]}");
+}
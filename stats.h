@@ -0,0 +1,61 @@
+#ifndef STATS_H
+#define STATS_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdio.h>
+#include <stdbool.h>
+#include "tracsasm.h"
+#include "trace.h"
+
+typedef enum statsPhase {
+    STATS_READ,             // Mapping or streaming the source text
+    STATS_TOKENIZE,         // Lexing and format correction
+    STATS_ENCODE,           // Label definition, emission and fixups, in one pass
+    STATS_OPTIMIZE,         // The -O passes and encoding again, only timed when they run
+    STATS_OUTPUT,           // Writing the selected output format
+    STATS_PHASES
+} STATS_PHASE;
+
+typedef struct statsRecord {
+    double seconds;
+    unsigned long long lines;
+    unsigned long long bytes;
+    unsigned long long allocations;
+    unsigned long long allocated_bytes;
+    long peak_rss_kb;       // Process-wide peak resident set at the end of the phase, 0 if unknown
+} STATS_RECORD;
+
+/*
+ * Per-phase counters for one assembly. Memory for the assembly is taken through allocator, which counts
+ * every call before passing it on to backing, so one STATS must not be shared between threads.
+ */
+typedef struct stats {
+    STATS_RECORD phases[STATS_PHASES];
+    TRACS_ALLOCATOR allocator;
+    const TRACS_ALLOCATOR *backing;     // Where allocator gets the memory, heap_allocator by default
+    unsigned long long allocations;
+    unsigned long long allocated_bytes;
+    STATS_PHASE phase;      // Phase between stats_begin() and stats_end()
+    double started;
+    unsigned long long startAllocations;
+    unsigned long long startBytes;
+    TRACE *trace;           // Every phase is also a span here, unless NULL
+    const char *input;      // Input named on the spans
+    int thread;             // Pool worker running the assembly
+} STATS;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+double stats_now(void);
+void stats_init(STATS *stats);
+void stats_begin(STATS *stats, STATS_PHASE phase);
+void stats_end(STATS *stats, unsigned long long lines, unsigned long long bytes);
+void stats_add(STATS *total, const STATS *stats);
+const char *stats_phase_name(STATS_PHASE phase);
+void stats_print(const STATS *stats, const char *name, FILE *file);
+void stats_print_json(const STATS *stats, const char *name, FILE *file);
+void print_json_string(const char *text, FILE *file);
+
+#endif
@@ -0,0 +1,341 @@
+/*======================================================================================================
+* FILE        : sweep.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the sweep executor, which runs one program over every combination of a
+*               set of input memory values and keeps the final status and watched memory of each run, in
+*               place of building and launching the MainMemory() harness once per input vector.
+*
+*               The vectors are cut into SWEEP_CHUNK tasks for the work-stealing pool, and every chunk is
+*               run BATCH_LANES vectors at a time on its worker's own BATCH. A task writes only its own
+*               slice of the result arrays and its worker's own counters, which are added up once the pool
+*               is done, so the workers never take a lock or share a cache line while running.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Timed with stats_now().
+*   16 October, 2026: V1.2 - Every chunk is a --trace span on its worker's track.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "batch.h"
+#include "pool.h"
+#include "stats.h"
+#include "sweep.h"
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+// Everything one worker touches while running; each is a separate allocation
+typedef struct sweepWorker {
+    BATCH batch;
+    unsigned long long status_counts[SIM_STEP_LIMIT + 1];
+    unsigned long long steps;
+} SWEEP_WORKER;
+
+typedef struct sweepJob {
+    SWEEP *sweep;
+    unsigned char image[TRACS_MEMORY_SIZE];
+    unsigned short pc;
+    SWEEP_WORKER **workers;
+} SWEEP_JOB;
+
+/*===============================================
+*   FUNCTION    :   sweep_init
+*   DESCRIPTION :   This function will clear a sweep: no inputs (one vector), nothing watched.
+*   ARGUMENTS   :   SWEEP *sweep
+*   RETURNS     :   VOID
+ *==============================================*/
+void sweep_init(SWEEP *sweep)
+{
+    memset(sweep, 0, sizeof(*sweep));
+    sweep->step_limit = SIM_DEFAULT_STEP_LIMIT;
+    sweep->vector_count = 1;
+}
+
+/*===============================================
+*   FUNCTION    :   parse_number
+*   DESCRIPTION :   This function will read a decimal or 0x-prefixed number no larger than max and move the
+*                   cursor past it.
+*   ARGUMENTS   :   const char **cursor, unsigned int max, unsigned int *value
+*   RETURNS     :   bool
+ *==============================================*/
+static bool parse_number(const char **cursor, unsigned int max, unsigned int *value)
+{
+    char *end;
+    if (**cursor < '0' || **cursor > '9')
+        return false;
+    unsigned long number = strtoul(*cursor, &end, 0);
+    if (end == *cursor || number > max)
+        return false;
+    *value = (unsigned int)number;
+    *cursor = end;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_parse_inputs
+*   DESCRIPTION :   This function will add the inputs of a comma-separated list of ADDRESS=LOW-HIGH or
+*                   ADDRESS=VALUE, e.g. "0x400=0-255,0x401=3".
+*   ARGUMENTS   :   SWEEP *sweep, const char *spec
+*   RETURNS     :   bool (false on a syntax error, too many inputs or too many vectors)
+ *==============================================*/
+bool sweep_parse_inputs(SWEEP *sweep, const char *spec)
+{
+    const char *cursor = spec;
+    for (;;) {
+        SWEEP_INPUT input;
+        if (sweep->input_count == SWEEP_MAX_INPUTS)
+            return false;
+        if (!parse_number(&cursor, TRACS_MEMORY_SIZE - 1, &input.address) || *cursor++ != '=')
+            return false;
+        if (!parse_number(&cursor, 0xFF, &input.low))
+            return false;
+        input.high = input.low;
+        if (*cursor == '-') {
+            cursor++;
+            if (!parse_number(&cursor, 0xFF, &input.high) || input.high < input.low)
+                return false;
+        }
+
+        unsigned long long count = sweep->vector_count * (input.high - input.low + 1);
+        if (count > SWEEP_MAX_VECTORS)
+            return false;
+        sweep->vector_count = count;
+        sweep->inputs[sweep->input_count++] = input;
+
+        if (*cursor == '\0')
+            return true;
+        if (*cursor++ != ',')
+            return false;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_parse_watch
+*   DESCRIPTION :   This function will set the memory kept from each run to FIRST-LAST or a single ADDRESS.
+*   ARGUMENTS   :   SWEEP *sweep, const char *spec
+*   RETURNS     :   bool
+ *==============================================*/
+bool sweep_parse_watch(SWEEP *sweep, const char *spec)
+{
+    const char *cursor = spec;
+    unsigned int first, last;
+    if (!parse_number(&cursor, TRACS_MEMORY_SIZE - 1, &first))
+        return false;
+    last = first;
+    if (*cursor == '-') {
+        cursor++;
+        if (!parse_number(&cursor, TRACS_MEMORY_SIZE - 1, &last) || last < first)
+            return false;
+    }
+    if (*cursor != '\0')
+        return false;
+    sweep->watch_address = first;
+    sweep->watch_count = last - first + 1;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   decode_vector
+*   DESCRIPTION :   This function will work out the input values of a vector number.
+*   ARGUMENTS   :   const SWEEP *sweep, unsigned long long vector, unsigned int *values
+*   RETURNS     :   VOID
+ *==============================================*/
+static void decode_vector(const SWEEP *sweep, unsigned long long vector, unsigned int *values)
+{
+    for (unsigned int i = sweep->input_count; i-- > 0;) {
+        unsigned int range = sweep->inputs[i].high - sweep->inputs[i].low + 1;
+        values[i] = sweep->inputs[i].low + (unsigned int)(vector % range);
+        vector /= range;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   next_vector
+*   DESCRIPTION :   This function will step the input values to the next vector, last input fastest.
+*   ARGUMENTS   :   const SWEEP *sweep, unsigned int *values
+*   RETURNS     :   VOID
+ *==============================================*/
+static void next_vector(const SWEEP *sweep, unsigned int *values)
+{
+    for (unsigned int i = sweep->input_count; i-- > 0;) {
+        if (values[i] < sweep->inputs[i].high) {
+            values[i]++;
+            return;
+        }
+        values[i] = sweep->inputs[i].low;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_task
+*   DESCRIPTION :   This function will run one chunk of vectors on a pool worker, BATCH_LANES at a time.
+*   ARGUMENTS   :   int index, int worker, void *context (SWEEP_JOB *)
+*   RETURNS     :   VOID
+ *==============================================*/
+static void sweep_task(int index, int worker, void *context)
+{
+    SWEEP_JOB *job = context;
+    SWEEP *sweep = job->sweep;
+    SWEEP_WORKER *state = job->workers[worker];
+    BATCH *batch = &state->batch;
+    unsigned long long first = (unsigned long long)index * SWEEP_CHUNK;
+    unsigned long long last = first + SWEEP_CHUNK < sweep->vector_count ? first + SWEEP_CHUNK : sweep->vector_count;
+    unsigned int values[SWEEP_MAX_INPUTS];
+    double started = sweep->trace != NULL ? stats_now() : 0;
+
+    decode_vector(sweep, first, values);
+    for (unsigned long long vector = first; vector < last; vector += BATCH_LANES) {
+        unsigned int lanes = last - vector < BATCH_LANES ? (unsigned int)(last - vector) : BATCH_LANES;
+        batch_restore(batch, job->image, job->pc, lanes);
+        for (unsigned int i = 0; i < sweep->input_count; i++)
+            batch->dirty[sweep->inputs[i].address] = 1;
+        for (unsigned int lane = 0; lane < lanes; lane++) {
+            for (unsigned int i = 0; i < sweep->input_count; i++)
+                batch->memory[sweep->inputs[i].address][lane] = (unsigned char)values[i];
+            next_vector(sweep, values);
+        }
+
+        batch_run(batch, sweep->step_limit);
+
+        for (unsigned int lane = 0; lane < lanes; lane++) {
+            unsigned char *result = sweep->results + (vector + lane) * sweep->watch_count;
+            for (unsigned int w = 0; w < sweep->watch_count; w++)
+                result[w] = batch->memory[sweep->watch_address + w][lane];
+            sweep->statuses[vector + lane] = (unsigned char)batch->status[lane];
+            state->status_counts[batch->status[lane]]++;
+            state->steps += batch->steps[lane];
+        }
+    }
+    if (sweep->trace != NULL)
+        trace_span(sweep->trace, "sweep chunk", NULL, worker, started, stats_now());
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_run
+*   DESCRIPTION :   This function will run the machine code once per input vector on every core (sweep->jobs
+*                   threads, 0 for one per core), filling in the results, the totals and the time taken.
+*   ARGUMENTS   :   SWEEP *sweep, const MACHINE_CODE *code
+*   RETURNS     :   bool (false if the code does not fit in memory or allocation fails)
+ *==============================================*/
+bool sweep_run(SWEEP *sweep, const MACHINE_CODE *code)
+{
+    unsigned long long tasks = (sweep->vector_count + SWEEP_CHUNK - 1) / SWEEP_CHUNK;
+    if (tasks > INT_MAX)
+        return false;
+    int workers = sweep->jobs > 0 ? sweep->jobs : pool_default_workers();
+    if (workers > (int)tasks)
+        workers = (int)tasks;
+
+    SWEEP_JOB *job = malloc(sizeof(SWEEP_JOB));
+    if (job == NULL)
+        return false;
+    job->sweep = sweep;
+    if (!buildMemoryImage(code, job->image, NULL)) {
+        free(job);
+        return false;
+    }
+    job->pc = code->count > 0 ? code->bytes[0].address : 0;
+
+    free(sweep->statuses);
+    free(sweep->results);
+    sweep->statuses = malloc(sweep->vector_count);
+    sweep->results = malloc(sweep->vector_count * sweep->watch_count + 1);
+    job->workers = calloc(workers, sizeof(SWEEP_WORKER *));
+    bool ok = sweep->statuses != NULL && sweep->results != NULL && job->workers != NULL;
+    for (int i = 0; ok && i < workers; i++) {
+        job->workers[i] = calloc(1, sizeof(SWEEP_WORKER));
+        ok = job->workers[i] != NULL && batch_load(&job->workers[i]->batch, code, BATCH_LANES);
+    }
+
+    if (ok) {
+        double start = stats_now();
+        ok = pool_run((int)tasks, workers, sweep_task, job);
+        sweep->seconds = stats_now() - start;
+        sweep->engine = batch_vectorized() ? "AVX2, 32 lanes" : "scalar";
+    }
+
+    memset(sweep->status_counts, 0, sizeof(sweep->status_counts));
+    sweep->steps = 0;
+    for (int i = 0; job->workers != NULL && i < workers; i++) {
+        if (job->workers[i] == NULL)
+            continue;
+        for (int status = 0; status <= SIM_STEP_LIMIT; status++)
+            sweep->status_counts[status] += job->workers[i]->status_counts[status];
+        sweep->steps += job->workers[i]->steps;
+        free(job->workers[i]);
+    }
+    free(job->workers);
+    free(job);
+    return ok;
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_free
+*   DESCRIPTION :   This function will free the results of a sweep.
+*   ARGUMENTS   :   SWEEP *sweep
+*   RETURNS     :   VOID
+ *==============================================*/
+void sweep_free(SWEEP *sweep)
+{
+    free(sweep->statuses);
+    free(sweep->results);
+    sweep->statuses = NULL;
+    sweep->results = NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_print
+*   DESCRIPTION :   This function will print one CSV row per vector: the input values, the final status and
+*                   the watched memory.
+*   ARGUMENTS   :   const SWEEP *sweep, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void sweep_print(const SWEEP *sweep, FILE *file)
+{
+    unsigned int values[SWEEP_MAX_INPUTS];
+
+    for (unsigned int i = 0; i < sweep->input_count; i++)
+        fprintf(file, "0x%03x,", sweep->inputs[i].address);
+    fprintf(file, "status");
+    for (unsigned int w = 0; w < sweep->watch_count; w++)
+        fprintf(file, ",0x%03x", sweep->watch_address + w);
+    fputc('\n', file);
+
+    decode_vector(sweep, 0, values);
+    for (unsigned long long vector = 0; vector < sweep->vector_count; vector++) {
+        for (unsigned int i = 0; i < sweep->input_count; i++)
+            fprintf(file, "0x%02x,", values[i]);
+        fputs(sim_status_name((SIM_STATUS)sweep->statuses[vector]), file);
+        const unsigned char *result = sweep->results + vector * sweep->watch_count;
+        for (unsigned int w = 0; w < sweep->watch_count; w++)
+            fprintf(file, ",0x%02x", result[w]);
+        fputc('\n', file);
+        next_vector(sweep, values);
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   sweep_print_summary
+*   DESCRIPTION :   This function will print how the runs ended and the throughput.
+*   ARGUMENTS   :   const SWEEP *sweep, FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void sweep_print_summary(const SWEEP *sweep, FILE *file)
+{
+    double seconds = sweep->seconds > 0 ? sweep->seconds : 1e-9;
+    fprintf(file, "Sweep: %llu vectors in %.3f s (%s): %.0f vectors/s, %.0f instructions/s\n", sweep->vector_count,
+            sweep->seconds, sweep->engine != NULL ? sweep->engine : "not run", sweep->vector_count / seconds,
+            sweep->steps / seconds);
+    for (int status = SIM_HALTED; status <= SIM_STEP_LIMIT; status++) {
+        if (sweep->status_counts[status] != 0)
+            fprintf(file, "  %s: %llu\n", sim_status_name((SIM_STATUS)status), sweep->status_counts[status]);
+    }
+}
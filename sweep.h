@@ -0,0 +1,53 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdio.h>
+#include <stdbool.h>
+#include "simulator.h"
+#include "trace.h"
+
+#define SWEEP_MAX_INPUTS    16
+#define SWEEP_MAX_VECTORS   (1ULL << 32)
+#define SWEEP_CHUNK         1024    // Vectors per pool task, a multiple of BATCH_LANES
+
+typedef struct sweepInput {
+    unsigned int address;
+    unsigned int low;           // Every value from low to high is tried
+    unsigned int high;
+} SWEEP_INPUT;
+
+/*
+ * One program run over every combination of the input values (the last input changes fastest). Each
+ * vector keeps its final status and the watched memory locations, in vector order.
+ */
+typedef struct sweep {
+    SWEEP_INPUT inputs[SWEEP_MAX_INPUTS];
+    unsigned int input_count;
+    unsigned int watch_address;
+    unsigned int watch_count;
+    unsigned long long step_limit;
+    int jobs;                                   // Worker threads, 0 for one per core
+    unsigned long long vector_count;
+    unsigned char *statuses;                    // SIM_STATUS of each vector
+    unsigned char *results;                     // watch_count bytes per vector
+    unsigned long long status_counts[SIM_STEP_LIMIT + 1];
+    unsigned long long steps;                   // Instructions executed over all vectors
+    double seconds;
+    const char *engine;
+    TRACE *trace;                               // One span per chunk, unless NULL
+} SWEEP;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void sweep_init(SWEEP *sweep);
+bool sweep_parse_inputs(SWEEP *sweep, const char *spec);
+bool sweep_parse_watch(SWEEP *sweep, const char *spec);
+bool sweep_run(SWEEP *sweep, const MACHINE_CODE *code);
+void sweep_free(SWEEP *sweep);
+void sweep_print(const SWEEP *sweep, FILE *file);
+void sweep_print_summary(const SWEEP *sweep, FILE *file);
+
+#endif
@@ -0,0 +1,217 @@
+/*======================================================================================================
+* FILE        : symtab.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the label symbol table used by the assembler. Labels are interned into
+*               a string pool and looked up through an open-addressing hash table with linear probing.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created, replaces the linear LABEL array scans in assemble().
+*   16 October, 2026: V1.1 - Memory comes from the caller's TRACS_ALLOCATOR.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <string.h>
+#include "allocator.h"
+#include "symtab.h"
+
+/*===============================================
+*   FUNCTION    :   hash_name
+*   DESCRIPTION :   This function will hash a label name (FNV-1a).
+*   ARGUMENTS   :   const char *name, size_t length
+*   RETURNS     :   unsigned int
+ *==============================================*/
+static unsigned int hash_name(const char *name, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*===============================================
+*   FUNCTION    :   probe
+*   DESCRIPTION :   This function will return the slot holding the name, or the empty slot where it belongs.
+*   ARGUMENTS   :   const SYMTAB *table, const char *name, size_t length, unsigned int hash
+*   RETURNS     :   unsigned int
+ *==============================================*/
+static unsigned int probe(const SYMTAB *table, const char *name, size_t length, unsigned int hash)
+{
+    unsigned int mask = table->capacity - 1;
+    unsigned int slot = hash & mask;
+    while (table->slots[slot] != -1) {
+        const SYMBOL *sym = &table->symbols[table->slots[slot]];
+        if (sym->hash == hash && sym->length == length && memcmp(table->pool + sym->name, name, length) == 0)
+            break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*===============================================
+*   FUNCTION    :   grow
+*   DESCRIPTION :   This function will double the slot array and rehash every symbol into it.
+*   ARGUMENTS   :   SYMTAB *table
+*   RETURNS     :   bool
+ *==============================================*/
+static bool grow(SYMTAB *table)
+{
+    unsigned int capacity = table->capacity * 2;
+    int *slots = ALLOCATE(table->allocator, capacity * sizeof(int));
+    if (slots == NULL)
+        return false;
+    memset(slots, -1, capacity * sizeof(int));
+    for (int i = 0; i < table->count; i++) {
+        unsigned int slot = table->symbols[i].hash & (capacity - 1);
+        while (slots[slot] != -1)
+            slot = (slot + 1) & (capacity - 1);
+        slots[slot] = i;
+    }
+    RELEASE(table->allocator, table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   symtab_init
+*   DESCRIPTION :   This function will create an empty table sized for the expected number of labels.
+*   ARGUMENTS   :   SYMTAB *table, int expected, const TRACS_ALLOCATOR *allocator
+*   RETURNS     :   bool
+ *==============================================*/
+bool symtab_init(SYMTAB *table, int expected, const TRACS_ALLOCATOR *allocator)
+{
+    memset(table, 0, sizeof(*table));
+    table->allocator = allocator;
+    table->capacity = SYMTAB_MIN_CAPACITY;
+    while (table->capacity < (unsigned int)expected * 2)
+        table->capacity *= 2;
+    table->slots = ALLOCATE(allocator, table->capacity * sizeof(int));
+    if (table->slots == NULL)
+        return false;
+    memset(table->slots, -1, table->capacity * sizeof(int));
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   symtab_free
+*   DESCRIPTION :   This function will release all memory owned by the table.
+*   ARGUMENTS   :   SYMTAB *table
+*   RETURNS     :   VOID
+ *==============================================*/
+void symtab_free(SYMTAB *table)
+{
+    const TRACS_ALLOCATOR *allocator = table->allocator;
+    if (table->slots != NULL)
+        RELEASE(allocator, table->slots);
+    if (table->symbols != NULL)
+        RELEASE(allocator, table->symbols);
+    if (table->pool != NULL)
+        RELEASE(allocator, table->pool);
+    memset(table, 0, sizeof(*table));
+    table->allocator = allocator;
+}
+
+/*===============================================
+*   FUNCTION    :   symtab_find
+*   DESCRIPTION :   This function will return the index of the named symbol, or -1 if it was never seen.
+*   ARGUMENTS   :   const SYMTAB *table, const char *name, size_t length
+*   RETURNS     :   int
+ *==============================================*/
+int symtab_find(const SYMTAB *table, const char *name, size_t length)
+{
+    return table->slots[probe(table, name, length, hash_name(name, length))];
+}
+
+/*===============================================
+*   FUNCTION    :   symtab_intern
+*   DESCRIPTION :   This function will return the index of the named symbol, adding it undefined if needed.
+*   ARGUMENTS   :   SYMTAB *table, const char *name, size_t length
+*   RETURNS     :   int (-1 on allocation failure)
+ *==============================================*/
+int symtab_intern(SYMTAB *table, const char *name, size_t length)
+{
+    unsigned int hash = hash_name(name, length);
+    unsigned int slot = probe(table, name, length, hash);
+    if (table->slots[slot] != -1)
+        return table->slots[slot];
+
+    // Keep the load factor at or below one half
+    if ((unsigned int)(table->count + 1) * 2 > table->capacity) {
+        if (!grow(table))
+            return -1;
+        slot = probe(table, name, length, hash);
+    }
+    if (table->count == table->symbol_capacity) {
+        int capacity = table->symbol_capacity ? table->symbol_capacity * 2 : SYMTAB_MIN_CAPACITY;
+        SYMBOL *symbols = REALLOCATE(table->allocator, table->symbols, table->symbol_capacity * sizeof(SYMBOL), capacity * sizeof(SYMBOL));
+        if (symbols == NULL)
+            return -1;
+        table->symbols = symbols;
+        table->symbol_capacity = capacity;
+    }
+    if (table->pool_used + length + 1 > table->pool_capacity) {
+        size_t capacity = table->pool_capacity ? table->pool_capacity : 1024;
+        while (table->pool_used + length + 1 > capacity)
+            capacity *= 2;
+        char *pool = REALLOCATE(table->allocator, table->pool, table->pool_capacity, capacity);
+        if (pool == NULL)
+            return -1;
+        table->pool = pool;
+        table->pool_capacity = capacity;
+    }
+
+    SYMBOL *sym = &table->symbols[table->count];
+    sym->name = (unsigned int)table->pool_used;
+    sym->length = (unsigned int)length;
+    sym->hash = hash;
+    sym->address = 0;
+    sym->defined = false;
+    sym->line = -1;
+    sym->fixups = -1;
+    memcpy(table->pool + table->pool_used, name, length);
+    table->pool[table->pool_used + length] = '\0';
+    table->pool_used += length + 1;
+    table->slots[slot] = table->count;
+    return table->count++;
+}
+
+/*===============================================
+*   FUNCTION    :   symtab_define
+*   DESCRIPTION :   This function will bind an address to the named symbol. Redefining a symbol leaves the
+*                   first definition in place and sets *duplicate.
+*   ARGUMENTS   :   SYMTAB *table, const char *name, size_t length, unsigned int address, int line, bool *duplicate
+*   RETURNS     :   int (-1 on allocation failure)
+ *==============================================*/
+int symtab_define(SYMTAB *table, const char *name, size_t length, unsigned int address, int line, bool *duplicate)
+{
+    int index = symtab_intern(table, name, length);
+    *duplicate = false;
+    if (index == -1)
+        return -1;
+    SYMBOL *sym = &table->symbols[index];
+    if (sym->defined) {
+        *duplicate = true;
+        return index;
+    }
+    sym->defined = true;
+    sym->address = address;
+    sym->line = line;
+    return index;
+}
+
+/*===============================================
+*   FUNCTION    :   symtab_name
+*   DESCRIPTION :   This function will return the interned name of a symbol.
+*   ARGUMENTS   :   const SYMTAB *table, int index
+*   RETURNS     :   const char *
+ *==============================================*/
+const char *symtab_name(const SYMTAB *table, int index)
+{
+    return table->pool + table->symbols[index].name;
+}
@@ -0,0 +1,44 @@
+#ifndef SYMTAB_H
+#define SYMTAB_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stddef.h>
+#include <stdbool.h>
+#include "tracsasm.h"
+
+#define SYMTAB_MIN_CAPACITY 64
+
+typedef struct symbol {
+    unsigned int name;      // Offset of the interned name in the string pool
+    unsigned int length;
+    unsigned int hash;
+    unsigned int address;
+    bool defined;
+    int line;               // Line that defined the symbol
+    int fixups;             // Head of the pending fixup chain, -1 if none
+} SYMBOL;
+
+typedef struct symtab {
+    int *slots;             // Open-addressed slots holding symbol indices, -1 if empty
+    unsigned int capacity;  // Always a power of two
+    SYMBOL *symbols;        // Symbols in insertion order
+    int count;
+    int symbol_capacity;
+    char *pool;             // Interned, NUL-terminated names
+    size_t pool_used;
+    size_t pool_capacity;
+    const TRACS_ALLOCATOR *allocator;
+} SYMTAB;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+bool symtab_init(SYMTAB *table, int expected, const TRACS_ALLOCATOR *allocator);
+void symtab_free(SYMTAB *table);
+int symtab_find(const SYMTAB *table, const char *name, size_t length);
+int symtab_intern(SYMTAB *table, const char *name, size_t length);
+int symtab_define(SYMTAB *table, const char *name, size_t length, unsigned int address, int line, bool *duplicate);
+const char *symtab_name(const SYMTAB *table, int index);
+
+#endif
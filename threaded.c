@@ -0,0 +1,223 @@
+/*======================================================================================================
+* FILE        : threaded.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the fast execution engine of the simulator. Main memory is decoded once
+*               into a direct-threaded stream (handler address and operand per slot) and run with computed
+*               goto, so each instruction costs one indirect jump instead of a fetch, decode and switch.
+*               The registers live in locals for the whole run.
+*
+*               It gives the same results as sim_run(). A WM marks the two slots it may have changed so
+*               they are decoded again when reached, and are restored from memory before the next run;
+*               self-modifying code therefore works, and a THREADED_CODE can be reused across runs of the
+*               same image. Anything else that changes memory between runs must call threaded_invalidate().
+*               Compilers without computed goto fall back to sim_run().
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <limits.h>
+#include "opcodes.h"
+#include "threaded.h"
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#define OPCODE_COUNT ((OPCODE_MASK >> 3) + 1)
+
+/*===============================================
+*   FUNCTION    :   threaded_init
+*   DESCRIPTION :   This function will prepare an empty THREADED_CODE; the first run decodes the machine's memory.
+*   ARGUMENTS   :   THREADED_CODE *code
+*   RETURNS     :   VOID
+ *==============================================*/
+void threaded_init(THREADED_CODE *code)
+{
+    code->modified_count = 0;
+    code->decode = NULL;
+    code->ready = false;
+}
+
+/*===============================================
+*   FUNCTION    :   threaded_invalidate
+*   DESCRIPTION :   This function will make the next run decode again the instructions that include the byte at
+*                   address. Call it after changing memory outside of a run.
+*   ARGUMENTS   :   THREADED_CODE *code, unsigned int address
+*   RETURNS     :   VOID
+ *==============================================*/
+void threaded_invalidate(THREADED_CODE *code, unsigned int address)
+{
+    if (!code->ready || address >= TRACS_MEMORY_SIZE)
+        return;
+    code->insn[address].handler = code->decode;
+    if (address > 0)
+        code->insn[address - 1].handler = code->decode;
+}
+
+/*===============================================
+*   FUNCTION    :   threaded_run
+*   DESCRIPTION :   This function will run the machine until EOP, a fault, or step_limit instructions (0 for no
+*                   limit), exactly like sim_run().
+*   ARGUMENTS   :   THREADED_CODE *code, MACHINE *machine, unsigned long long step_limit
+*   RETURNS     :   SIM_STATUS
+ *==============================================*/
+SIM_STATUS threaded_run(THREADED_CODE *code, MACHINE *machine, unsigned long long step_limit)
+{
+#if !defined(__GNUC__)
+    (void)code;
+    return sim_run(machine, step_limit);
+#else
+    static const void *const opcodes[OPCODE_COUNT] = {
+#define X(name, a, b, c, d, opcode, kind) [OP_##name >> 3] = &&op_##name,
+        TRACS_MNEMONICS(X)
+#undef X
+    };
+
+    if (machine->status != SIM_RUNNING)
+        return machine->status;
+    if (machine->pc + 1 >= TRACS_MEMORY_SIZE)
+        return machine->status = SIM_PC_OUT_OF_RANGE;
+
+    THREADED_INSN *insn = code->insn;
+    unsigned char *memory = machine->memory;
+
+#define DECODE(slot) do { \
+        unsigned int at_ = (slot); \
+        if (at_ + 1 >= TRACS_MEMORY_SIZE) { \
+            insn[at_].handler = &&out_of_range; \
+        } else { \
+            const void *handler_ = opcodes[memory[at_] >> 3]; \
+            insn[at_].handler = handler_ != NULL ? handler_ : &&invalid_opcode; \
+            insn[at_].operand = ((memory[at_] & 0x07) << 8) | memory[at_ + 1]; \
+        } \
+    } while (0)
+
+    // Decode everything on the first run; later runs only restore what the last run overwrote
+    if (!code->ready) {
+        for (unsigned int slot = 0; slot <= TRACS_MEMORY_SIZE; slot++) {
+            DECODE(slot);
+            insn[slot].modified = false;
+        }
+        code->modified_count = 0;
+        code->decode = &&decode;
+        code->ready = true;
+    }
+    while (code->modified_count > 0) {
+        unsigned int slot = code->modified[--code->modified_count];
+        DECODE(slot);
+        insn[slot].modified = false;
+    }
+
+    unsigned char acc = machine->acc;
+    unsigned char mbr = machine->mbr;
+    unsigned char iob = machine->iob;
+    unsigned char flags = machine->flags;
+    unsigned long long budget = step_limit == 0 ? ULLONG_MAX : step_limit > machine->steps ? step_limit - machine->steps : 1;
+    unsigned long long remaining = budget;
+    const THREADED_INSN *ip = &insn[machine->pc];
+
+#define DISPATCH()      goto *ip->handler
+#define NEXT()          do { ip += 2; if (--remaining == 0) goto step_limit_reached; DISPATCH(); } while (0)
+#define JUMP(target)    do { ip = &insn[target]; if (--remaining == 0) goto step_limit_reached; DISPATCH(); } while (0)
+#define SET_FLAGS(result, carry, overflow) \
+    flags = ((result) == 0 ? FLAG_ZERO : 0) | ((carry) ? FLAG_CARRY : 0) | \
+            ((result) & 0x80 ? FLAG_SIGN : 0) | ((overflow) ? FLAG_OVERFLOW : 0)
+#define COMPARE() do { \
+        unsigned char result_ = acc - mbr; \
+        SET_FLAGS(result_, acc < mbr, ((acc ^ mbr) & (acc ^ result_) & 0x80) != 0); \
+    } while (0)
+#define MODIFY(slot) do { \
+        THREADED_INSN *written_ = &insn[slot]; \
+        written_->handler = &&decode; \
+        if (!written_->modified) { \
+            written_->modified = true; \
+            code->modified[code->modified_count++] = (slot); \
+        } \
+    } while (0)
+
+    DISPATCH();
+
+decode:
+    DECODE((unsigned int)(ip - insn));
+    DISPATCH();
+
+op_WB:   mbr = (unsigned char)ip->operand; NEXT();
+op_WM:
+    memory[ip->operand] = mbr;
+    MODIFY(ip->operand);
+    if (ip->operand > 0)
+        MODIFY(ip->operand - 1);
+    NEXT();
+op_RM:   mbr = memory[ip->operand]; NEXT();
+op_WACC: acc = mbr; NEXT();
+op_WIB:  iob = (unsigned char)ip->operand; NEXT();
+op_WIO:  machine->io[ip->operand] = iob; NEXT();
+op_RACC: mbr = acc; NEXT();
+op_SWAP: { unsigned char swapped = mbr; mbr = iob; iob = swapped; } NEXT();
+op_ADD: {
+    unsigned char result = acc + mbr;
+    SET_FLAGS(result, acc + mbr > 0xFF, (~(acc ^ mbr) & (acc ^ result) & 0x80) != 0);
+    acc = result;
+    NEXT();
+}
+op_SUB: {
+    unsigned char result = acc - mbr;
+    SET_FLAGS(result, acc < mbr, ((acc ^ mbr) & (acc ^ result) & 0x80) != 0);
+    acc = result;
+    NEXT();
+}
+op_MUL: {
+    unsigned char result = acc * mbr;
+    SET_FLAGS(result, acc * mbr > 0xFF, false);
+    acc = result;
+    NEXT();
+}
+op_AND:  acc &= mbr; SET_FLAGS(acc, false, false); NEXT();
+op_OR:   acc |= mbr; SET_FLAGS(acc, false, false); NEXT();
+op_XOR:  acc ^= mbr; SET_FLAGS(acc, false, false); NEXT();
+op_NOT:  acc = ~acc; SET_FLAGS(acc, false, false); NEXT();
+op_SHL:  SET_FLAGS((unsigned char)(acc << 1), acc & 0x80, false); acc <<= 1; NEXT();
+op_SHR:  SET_FLAGS(acc >> 1, acc & 0x01, false); acc >>= 1; NEXT();
+op_BR:   JUMP(ip->operand);
+op_BRE:  COMPARE(); if (acc == mbr) JUMP(ip->operand); NEXT();
+op_BRNE: COMPARE(); if (acc != mbr) JUMP(ip->operand); NEXT();
+op_BRGT: COMPARE(); if (acc > mbr) JUMP(ip->operand); NEXT();
+op_BRLT: COMPARE(); if (acc < mbr) JUMP(ip->operand); NEXT();
+op_EOP:
+    ip += 2;
+    remaining--;
+    machine->status = SIM_HALTED;
+    goto done;
+
+invalid_opcode:
+    machine->status = SIM_INVALID_OPCODE;
+    goto done;
+out_of_range:
+    machine->status = SIM_PC_OUT_OF_RANGE;
+    goto done;
+step_limit_reached:
+    machine->status = SIM_STEP_LIMIT;
+
+done:
+    machine->acc = acc;
+    machine->mbr = mbr;
+    machine->iob = iob;
+    machine->flags = flags;
+    machine->pc = (unsigned int)(ip - insn);
+    machine->steps += budget - remaining;
+    return machine->status;
+
+#undef DECODE
+#undef DISPATCH
+#undef NEXT
+#undef JUMP
+#undef SET_FLAGS
+#undef COMPARE
+#undef MODIFY
+#endif
+}
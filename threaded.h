@@ -0,0 +1,34 @@
+#ifndef THREADED_H
+#define THREADED_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdbool.h>
+#include "simulator.h"
+
+typedef struct threaded_insn {
+    const void *handler;        // Label of the code that executes this instruction
+    unsigned short operand;     // 11-bit operand, the immediate is its low byte
+    bool modified;              // Redecoded during a run because the program wrote to it
+} THREADED_INSN;
+
+/*
+ * Direct-threaded form of main memory: one slot per byte address, since a branch may land on an odd
+ * address. The extra slot past the end catches a PC that runs off the top of memory.
+ */
+typedef struct threaded_code {
+    THREADED_INSN insn[TRACS_MEMORY_SIZE + 1];
+    unsigned short modified[TRACS_MEMORY_SIZE];  // Slots to redecode before the next run
+    unsigned int modified_count;
+    const void *decode;                          // Handler that redecodes its slot, set by the first run
+    bool ready;
+} THREADED_CODE;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void threaded_init(THREADED_CODE *code);
+void threaded_invalidate(THREADED_CODE *code, unsigned int address);
+SIM_STATUS threaded_run(THREADED_CODE *code, MACHINE *machine, unsigned long long step_limit);
+
+#endif
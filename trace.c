@@ -0,0 +1,116 @@
+/*======================================================================================================
+* FILE        : trace.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the --trace recorder. Spans are kept in memory under one lock, which is
+*               only taken once per finished span, and written as Chrome trace-event JSON ("X" complete
+*               events, one track per pool worker) when the run is over.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+#include "trace.h"
+
+/*===============================================
+*   FUNCTION    :   trace_init
+*   DESCRIPTION :   This function will start an empty trace whose timeline begins now.
+*   ARGUMENTS   :   TRACE *trace
+*   RETURNS     :   VOID
+ *==============================================*/
+void trace_init(TRACE *trace)
+{
+    memset(trace, 0, sizeof(*trace));
+    pthread_mutex_init(&trace->lock, NULL);
+    trace->threads = 1;
+    trace->origin = stats_now();
+}
+
+/*===============================================
+*   FUNCTION    :   trace_free
+*   DESCRIPTION :   This function will release the spans.
+*   ARGUMENTS   :   TRACE *trace
+*   RETURNS     :   VOID
+ *==============================================*/
+void trace_free(TRACE *trace)
+{
+    free(trace->events);
+    pthread_mutex_destroy(&trace->lock);
+    trace->events = NULL;
+    trace->count = trace->capacity = 0;
+}
+
+/*===============================================
+*   FUNCTION    :   trace_span
+*   DESCRIPTION :   This function will add a finished span. A NULL trace does nothing, and a span that does not
+*                   fit in memory is dropped.
+*   ARGUMENTS   :   TRACE *trace, const char *name, const char *input, int thread, double start, double end
+*   RETURNS     :   VOID
+ *==============================================*/
+void trace_span(TRACE *trace, const char *name, const char *input, int thread, double start, double end)
+{
+    if (trace == NULL)
+        return;
+    pthread_mutex_lock(&trace->lock);
+    if (trace->count == trace->capacity) {
+        int capacity = trace->capacity ? trace->capacity * 2 : 256;
+        TRACE_EVENT *events = realloc(trace->events, capacity * sizeof(TRACE_EVENT));
+        if (events == NULL) {
+            pthread_mutex_unlock(&trace->lock);
+            return;
+        }
+        trace->events = events;
+        trace->capacity = capacity;
+    }
+    TRACE_EVENT event = { name, input, thread, start, end };
+    trace->events[trace->count++] = event;
+    if (thread >= trace->threads)
+        trace->threads = thread + 1;
+    pthread_mutex_unlock(&trace->lock);
+}
+
+/*===============================================
+*   FUNCTION    :   trace_write
+*   DESCRIPTION :   This function will write every span to a Chrome trace-event JSON file, with times in
+*                   microseconds from trace_init().
+*   ARGUMENTS   :   const TRACE *trace, const char *filename
+*   RETURNS     :   bool
+ *==============================================*/
+bool trace_write(const TRACE *trace, const char *filename)
+{
+    FILE *file = fopen(filename, "w");
+    if (file == NULL)
+        return false;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int thread = 0; thread < trace->threads; thread++) {
+        fprintf(file, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%s %d\"}}",
+                thread > 0 ? ",\n" : "", thread, thread == 0 ? "main" : "worker", thread);
+    }
+    for (int i = 0; i < trace->count; i++) {
+        const TRACE_EVENT *event = &trace->events[i];
+        fprintf(file, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":", event->thread);
+        print_json_string(event->name, file);
+        fprintf(file, ",\"ts\":%.3f,\"dur\":%.3f", (event->start - trace->origin) * 1e6, (event->end - event->start) * 1e6);
+        if (event->input != NULL) {
+            fprintf(file, ",\"args\":{\"input\":");
+            print_json_string(event->input, file);
+            fputc('}', file);
+        }
+        fputc('}', file);
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
@@ -0,0 +1,38 @@
+#ifndef TRACE_H
+#define TRACE_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef struct traceEvent {
+    const char *name;       // Static strings; the trace keeps only the pointers
+    const char *input;      // NULL if the span is not tied to one input
+    int thread;             // Pool worker index, 0 is the main thread
+    double start;           // stats_now() seconds
+    double end;
+} TRACE_EVENT;
+
+/*
+ * Spans collected from any thread and written out at the end as Chrome trace-event JSON, which
+ * chrome://tracing and ui.perfetto.dev can open.
+ */
+typedef struct trace {
+    pthread_mutex_t lock;
+    TRACE_EVENT *events;
+    int count;
+    int capacity;
+    int threads;            // Highest thread index seen plus one
+    double origin;          // Time of trace_init(), the zero of the timeline
+} TRACE;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void trace_init(TRACE *trace);
+void trace_free(TRACE *trace);
+void trace_span(TRACE *trace, const char *name, const char *input, int thread, double start, double end);
+bool trace_write(const TRACE *trace, const char *filename);
+
+#endif
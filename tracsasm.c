@@ -0,0 +1,83 @@
+/*======================================================================================================
+* FILE        : tracsasm.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains the public libtracsasm entry points declared in tracsasm.h. They wrap
+*               process_buffer() and assemble_program() so the assembler can be embedded in-process.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Diagnostics are returned in source order with their column.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <string.h>
+#include "allocator.h"
+#include "assembler.h"
+#include "tracsasm.h"
+
+/*===============================================
+*   FUNCTION    :   tracs_assemble
+*   DESCRIPTION :   This function will assemble source text in memory into machine code in memory.
+*   ARGUMENTS   :   const char *source, size_t size, const TRACS_ALLOCATOR *allocator, TRACS_RESULT *result
+*   RETURNS     :   bool
+ *==============================================*/
+TRACSASM_API bool tracs_assemble(const char *source, size_t size, const TRACS_ALLOCATOR *allocator, TRACS_RESULT *result)
+{
+    if (allocator == NULL)
+        allocator = &heap_allocator;
+    memset(result, 0, sizeof(*result));
+    result->allocator = allocator;
+
+    PROGRAM program;
+    MACHINE_CODE code = { NULL, 0, 0, allocator };
+    DIAGNOSTICS diagnostics;
+    diagnostics_init(&diagnostics, allocator);
+
+    bool success = false;
+    if (process_buffer(source, size, allocator, &program, &diagnostics)) {
+        success = assemble_program(&program, &code, &diagnostics);
+        free_program(&program);
+    }
+    diagnostics_sort(&diagnostics);
+
+    // Hand both lists over to the caller
+    if (success) {
+        result->bytes = code.bytes;
+        result->byte_count = code.count;
+    }
+    result->diagnostics = diagnostics.items;
+    result->diagnostic_count = diagnostics.count;
+    result->error_count = diagnostics.errors;
+    return success;
+}
+
+/*===============================================
+*   FUNCTION    :   tracs_free_result
+*   DESCRIPTION :   This function will release everything tracs_assemble() allocated for the result.
+*   ARGUMENTS   :   TRACS_RESULT *result
+*   RETURNS     :   VOID
+ *==============================================*/
+TRACSASM_API void tracs_free_result(TRACS_RESULT *result)
+{
+    const TRACS_ALLOCATOR *allocator = result->allocator != NULL ? result->allocator : &heap_allocator;
+    MACHINE_CODE code = { result->bytes, result->byte_count, result->byte_count, allocator };
+    DIAGNOSTICS diagnostics = { result->diagnostics, result->diagnostic_count, result->diagnostic_count, result->error_count, allocator };
+    freeMachineCode(&code);
+    diagnostics_free(&diagnostics);
+    memset(result, 0, sizeof(*result));
+}
+
+/*===============================================
+*   FUNCTION    :   tracs_version
+*   DESCRIPTION :   This function will return the library version string.
+*   ARGUMENTS   :   VOID
+*   RETURNS     :   const char *
+ *==============================================*/
+TRACSASM_API const char *tracs_version(void)
+{
+    return TRACSASM_VERSION;
+}
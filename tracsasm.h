@@ -0,0 +1,81 @@
+#ifndef TRACSASM_H
+#define TRACSASM_H
+/*===============================================
+ *   libtracsasm - reentrant TRACS assembler API
+ *
+ *   Assembles source text held in memory into machine code held in memory. Nothing is read from or
+ *   written to files or the console; problems are returned as a list of diagnostics. Calls share no
+ *   state, so any number of them may run at once on different threads.
+ *==============================================*/
+#include <stddef.h>
+#include <stdbool.h>
+
+#if defined(_WIN32) && defined(TRACSASM_BUILD_DLL)
+#define TRACSASM_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(TRACSASM_DLL)
+#define TRACSASM_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define TRACSASM_API __attribute__((visibility("default")))
+#else
+#define TRACSASM_API
+#endif
+
+#define TRACSASM_VERSION "3.3"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+// Every allocation made for an assembly goes through this. old_size is the size of the block being
+// resized (0 for a new block), so allocators that do not track sizes can still copy it.
+typedef struct tracs_allocator {
+    void *(*allocate)(void *context, size_t size);
+    void *(*reallocate)(void *context, void *pointer, size_t old_size, size_t size);
+    void (*release)(void *context, void *pointer);
+    void *context;
+} TRACS_ALLOCATOR;
+
+typedef enum tracs_severity {
+    TRACS_ERROR,
+    TRACS_WARNING
+} TRACS_SEVERITY;
+
+typedef struct tracs_diagnostic {
+    TRACS_SEVERITY severity;
+    unsigned int line;          // 1-based source line, 0 if the problem is not tied to a line
+    char *message;
+    unsigned int column;        // 1-based column of the offending token, 0 if not tied to one
+} TRACS_DIAGNOSTIC;
+
+typedef struct tracs_byte {
+    unsigned int address;       // Not limited to the address space; only a memory image checks that
+    unsigned char value;
+} TRACS_BYTE;
+
+typedef struct tracs_result {
+    TRACS_BYTE *bytes;          // Opcode byte then operand byte of every instruction, in program order
+    int byte_count;
+    TRACS_DIAGNOSTIC *diagnostics;
+    int diagnostic_count;
+    int error_count;
+    const TRACS_ALLOCATOR *allocator;
+} TRACS_RESULT;
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+// Returns true if the source assembled without errors. The result is filled in either way (bytes are
+// only present on success) and must be released with tracs_free_result(). A NULL allocator uses malloc.
+// Every problem in the source is collected, sorted by line and column.
+TRACSASM_API bool tracs_assemble(const char *source, size_t size, const TRACS_ALLOCATOR *allocator, TRACS_RESULT *result);
+TRACSASM_API void tracs_free_result(TRACS_RESULT *result);
+TRACSASM_API const char *tracs_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
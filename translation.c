@@ -4,10 +4,16 @@
 *               Ben Cesar Cadungog (Software Lead)
 *               Jeddah Laine Luce�ara  (Research Lead)
 *               Harold Marvin Comendador (Documentation Lead)
-* DESCRIPTION : This file contains the implementation of the functions that interpret the translation.txt file.
+* DESCRIPTION : This file contains the machine code buffer handed over by the assembler, the writers for its
+*               output formats, and the reader for existing translation.txt files.
 * COPYRIGHT   : 24 April, 2024
 * REVISION HISTORY:
 *   21 April, 2024: V1.0 - File Created, made interpreter function to read translation.txt file.
+*   16 October, 2026: V1.1 - Removed the 1000 line cap, the array now grows with the file.
+*   16 October, 2026: V1.2 - Added the in-memory MACHINE_CODE buffer and its text writers.
+*   16 October, 2026: V1.3 - Added raw binary memory image and Intel HEX writers.
+*   16 October, 2026: V1.4 - MACHINE_CODE memory comes from a TRACS_ALLOCATOR.
+*   16 October, 2026: V1.5 - Addresses are kept whole instead of wrapping at 0x10000.
 ======================================================================================================*/
 /*===============================================
  *   HEADER FILES
@@ -15,21 +21,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include "allocator.h"
 #include "translation.h"
 
+/*===============================================
+*   FUNCTION    :   interpretTranslation
+*   DESCRIPTION :   This function will read a translation.txt file back into an array of MACHINE_CODE_LINE.
+*   ARGUMENTS   :   const char* filename, int* line_count
+*   RETURNS     :   MACHINE_CODE_LINE*
+ *==============================================*/
 MACHINE_CODE_LINE* interpretTranslation(const char* filename, int* line_count) 
 {
     FILE *file = fopen(filename, "r");
     if (file == NULL) {
-        printf("Error opening file.\n");
+        fprintf(stderr, "Error opening file.\n");
         return NULL;
     }
 
-    // Allocate memory for the array of MACHINE_CODE_LINE
-    MACHINE_CODE_LINE* array = (MACHINE_CODE_LINE*)malloc(MAX_LINES * sizeof(MACHINE_CODE_LINE));
+    // The array grows with the file, starting with room for TRANSLATION_INITIAL_LINES lines
+    int capacity = TRANSLATION_INITIAL_LINES;
+    MACHINE_CODE_LINE* array = (MACHINE_CODE_LINE*)malloc(capacity * sizeof(MACHINE_CODE_LINE));
     if (array == NULL) {
         fclose(file);
-        printf("Memory allocation failed.\n");
+        fprintf(stderr, "Memory allocation failed.\n");
         return NULL;
     }
 
@@ -37,20 +52,185 @@ MACHINE_CODE_LINE* interpretTranslation(const char* filename, int* line_count)
 
     char line[100]; // Buffer to read each line
     while (fgets(line, sizeof(line), file) != NULL) {
+        if (*line_count == capacity) {
+            capacity *= 2;
+            MACHINE_CODE_LINE* grown = (MACHINE_CODE_LINE*)realloc(array, capacity * sizeof(MACHINE_CODE_LINE));
+            if (grown == NULL) {
+                fclose(file);
+                free(array);
+                fprintf(stderr, "Memory allocation failed.\n");
+                return NULL;
+            }
+            array = grown;
+        }
         // Parsing the line
-        sscanf(line, "%s %s %s %s",
+        if (sscanf(line, "%7s %7s %7s %7s",
                array[*line_count].opcodeAddress,
                array[*line_count].opcode,
                array[*line_count].operandAddress,
-               array[*line_count].operand);
-        (*line_count)++; // Increment line count
-        if (*line_count >= MAX_LINES) {
-            // Reached maximum number of lines, break out of loop
-            printf("Maximum number of lines reached.\n");
-            break;
-        }
+               array[*line_count].operand) == 4)
+            (*line_count)++; // Increment line count
     }
 
     fclose(file);
     return array;
+}
+
+/*===============================================
+*   FUNCTION    :   initMachineCode
+*   DESCRIPTION :   This function will create an empty buffer with room for the given number of instructions.
+*   ARGUMENTS   :   MACHINE_CODE* code, int instructions, const TRACS_ALLOCATOR* allocator
+*   RETURNS     :   bool
+ *==============================================*/
+bool initMachineCode(MACHINE_CODE* code, int instructions, const TRACS_ALLOCATOR* allocator)
+{
+    code->allocator = allocator;
+    code->count = 0;
+    code->capacity = 2 * (instructions > 0 ? instructions : 1);
+    code->bytes = (MACHINE_BYTE*)ALLOCATE(allocator, code->capacity * sizeof(MACHINE_BYTE));
+    if (code->bytes == NULL)
+        code->capacity = 0;
+    return code->bytes != NULL;
+}
+
+/*===============================================
+*   FUNCTION    :   appendMachineCode
+*   DESCRIPTION :   This function will add one 16-bit instruction word, opcode byte first.
+*   ARGUMENTS   :   MACHINE_CODE* code, unsigned int address, unsigned int word
+*   RETURNS     :   bool
+ *==============================================*/
+bool appendMachineCode(MACHINE_CODE* code, unsigned int address, unsigned int word)
+{
+    if (code->count + 2 > code->capacity) {
+        int capacity = code->capacity ? code->capacity * 2 : 64;
+        MACHINE_BYTE* bytes = (MACHINE_BYTE*)REALLOCATE(code->allocator, code->bytes, code->capacity * sizeof(MACHINE_BYTE), capacity * sizeof(MACHINE_BYTE));
+        if (bytes == NULL)
+            return false;
+        code->bytes = bytes;
+        code->capacity = capacity;
+    }
+    code->bytes[code->count].address = address;
+    code->bytes[code->count].value = (word >> 8) & 0xFF;
+    code->bytes[code->count + 1].address = address + 1;
+    code->bytes[code->count + 1].value = word & 0xFF;
+    code->count += 2;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   freeMachineCode
+*   DESCRIPTION :   This function will release the buffer.
+*   ARGUMENTS   :   MACHINE_CODE* code
+*   RETURNS     :   VOID
+ *==============================================*/
+void freeMachineCode(MACHINE_CODE* code)
+{
+    if (code->bytes != NULL)
+        RELEASE(code->allocator, code->bytes);
+    code->bytes = NULL;
+    code->count = 0;
+    code->capacity = 0;
+}
+
+/*===============================================
+*   FUNCTION    :   writeTranslation
+*   DESCRIPTION :   This function will write the buffer in the translation.txt format, one instruction per line.
+*   ARGUMENTS   :   const MACHINE_CODE* code, FILE* file
+*   RETURNS     :   bool
+ *==============================================*/
+bool writeTranslation(const MACHINE_CODE* code, FILE* file)
+{
+    for (int i = 0; i + 1 < code->count; i += 2) {
+        fprintf(file, "0x%02x 0x%02x\t0x%02x 0x%02x\n",
+                code->bytes[i].address, code->bytes[i].value,
+                code->bytes[i + 1].address, code->bytes[i + 1].value);
+    }
+    return !ferror(file);
+}
+
+/*===============================================
+*   FUNCTION    :   printMainMemory
+*   DESCRIPTION :   This function will print the TRACS "C" statements that load the buffer into main memory.
+*   ARGUMENTS   :   const MACHINE_CODE* code, FILE* file
+*   RETURNS     :   VOID
+ *==============================================*/
+void printMainMemory(const MACHINE_CODE* code, FILE* file)
+{
+    for (int i = 0; i < code->count; i++) {
+        fprintf(file, "ADDR = 0x%02x; BUS = 0x%02x; MainMemory();\n", code->bytes[i].address, code->bytes[i].value);
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   buildMemoryImage
+*   DESCRIPTION :   This function will lay the buffer out as a flat TRACS memory image of TRACS_MEMORY_SIZE bytes.
+*                   Unused locations are 0x00 and, if used is not NULL, are marked false in it.
+*   ARGUMENTS   :   const MACHINE_CODE* code, unsigned char* image, bool* used
+*   RETURNS     :   bool (false if the program does not fit in the address space)
+ *==============================================*/
+bool buildMemoryImage(const MACHINE_CODE* code, unsigned char* image, bool* used)
+{
+    memset(image, 0, TRACS_MEMORY_SIZE);
+    if (used != NULL)
+        memset(used, 0, TRACS_MEMORY_SIZE * sizeof(bool));
+    for (int i = 0; i < code->count; i++) {
+        if (code->bytes[i].address >= TRACS_MEMORY_SIZE)
+            return false;
+        image[code->bytes[i].address] = code->bytes[i].value;
+        if (used != NULL)
+            used[code->bytes[i].address] = true;
+    }
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   writeBinaryImage
+*   DESCRIPTION :   This function will write the full memory image as raw bytes, address 0x000 first, so a
+*                   loader can map the file straight into simulated memory.
+*   ARGUMENTS   :   const MACHINE_CODE* code, FILE* file
+*   RETURNS     :   bool
+ *==============================================*/
+bool writeBinaryImage(const MACHINE_CODE* code, FILE* file)
+{
+    unsigned char image[TRACS_MEMORY_SIZE];
+    if (!buildMemoryImage(code, image, NULL))
+        return false;
+    return fwrite(image, 1, TRACS_MEMORY_SIZE, file) == TRACS_MEMORY_SIZE;
+}
+
+/*===============================================
+*   FUNCTION    :   writeIntelHex
+*   DESCRIPTION :   This function will write the used parts of the memory image as Intel HEX data records of up
+*                   to IHEX_RECORD_BYTES bytes, followed by the end-of-file record.
+*   ARGUMENTS   :   const MACHINE_CODE* code, FILE* file
+*   RETURNS     :   bool
+ *==============================================*/
+bool writeIntelHex(const MACHINE_CODE* code, FILE* file)
+{
+    unsigned char image[TRACS_MEMORY_SIZE];
+    bool used[TRACS_MEMORY_SIZE];
+    if (!buildMemoryImage(code, image, used))
+        return false;
+
+    unsigned int address = 0;
+    while (address < TRACS_MEMORY_SIZE) {
+        if (!used[address]) {
+            address++;
+            continue;
+        }
+        // One record per run of contiguous bytes, split at IHEX_RECORD_BYTES
+        unsigned int length = 0;
+        while (length < IHEX_RECORD_BYTES && address + length < TRACS_MEMORY_SIZE && used[address + length])
+            length++;
+        unsigned int checksum = length + ((address >> 8) & 0xFF) + (address & 0xFF);
+        fprintf(file, ":%02X%04X00", length, address);
+        for (unsigned int i = 0; i < length; i++) {
+            fprintf(file, "%02X", image[address + i]);
+            checksum += image[address + i];
+        }
+        fprintf(file, "%02X\n", (0x100 - (checksum & 0xFF)) & 0xFF);
+        address += length;
+    }
+    fprintf(file, ":00000001FF\n");
+    return !ferror(file);
 }
\ No newline at end of file
@@ -1,10 +1,15 @@
 #ifndef TRANSLATION_H
 #define TRANSLATION_H
+#include <stdio.h>
+#include <stdbool.h>
+#include "tracsasm.h"
 /*===============================================
  *   STRUCTS & DEFINITIONS
  *==============================================*/
 
-#define MAX_LINES 1000
+#define TRANSLATION_INITIAL_LINES 256
+#define TRACS_MEMORY_SIZE 0x800     // 11-bit address bus
+#define IHEX_RECORD_BYTES 16
 
 typedef struct machine_code_line {
     char opcode[8];
@@ -13,9 +18,26 @@ typedef struct machine_code_line {
     char operandAddress[8];
 } MACHINE_CODE_LINE;
 
+typedef TRACS_BYTE MACHINE_BYTE;
+
+typedef struct machine_code {
+    MACHINE_BYTE* bytes;    // Opcode byte then operand byte of every instruction, in program order
+    int count;
+    int capacity;
+    const TRACS_ALLOCATOR* allocator;
+} MACHINE_CODE;
+
 /*===============================================
  *   FUNCTION PROTOTYPES
  *==============================================*/
 MACHINE_CODE_LINE* interpretTranslation(const char* filename, int* line_count);
+bool initMachineCode(MACHINE_CODE* code, int instructions, const TRACS_ALLOCATOR* allocator);
+bool appendMachineCode(MACHINE_CODE* code, unsigned int address, unsigned int word);
+void freeMachineCode(MACHINE_CODE* code);
+bool writeTranslation(const MACHINE_CODE* code, FILE* file);
+void printMainMemory(const MACHINE_CODE* code, FILE* file);
+bool buildMemoryImage(const MACHINE_CODE* code, unsigned char* image, bool* used);
+bool writeBinaryImage(const MACHINE_CODE* code, FILE* file);
+bool writeIntelHex(const MACHINE_CODE* code, FILE* file);
 
 #endif
@@ -0,0 +1,731 @@
+/*======================================================================================================
+* FILE        : watch.c
+* AUTHOR      : Josh Ratificar (Hardware Lead)
+*               Ben Cesar Cadungog (Software Lead)
+*               Jeddah Laine Lucenara  (Research Lead)
+*               Harold Marvin Comendador (Documentation Lead)
+* DESCRIPTION : This file contains --watch: the inputs are assembled, then reassembled whenever they are
+*               saved. The lines, symbol table and machine code of each input stay resident, so an edit to
+*               a program without errors is patched in by lexing and encoding only the changed lines; the
+*               lines after the edit are only moved, and only the uses of labels that moved are resolved
+*               again.
+*               Changes are seen through inotify on Linux and by polling stat() elsewhere.
+* COPYRIGHT   : 16 October, 2026
+* REVISION HISTORY:
+*   16 October, 2026: V1.0 - File Created.
+*   16 October, 2026: V1.1 - Inputs can be watched at an -O level, which always assembles in full.
+*   16 October, 2026: V1.2 - Releases the copy of the text that -O3 constant folding makes.
+*   16 October, 2026: V1.3 - An operand out of range is assembled in full, so its error is shown.
+*   16 October, 2026: V1.4 - Patched lines are encoded by the same helpers as assemble_program().
+*   16 October, 2026: V1.5 - Only a build without errors is optimized, as in assemble().
+*   16 October, 2026: V1.6 - An ORG address outside the address space is never indexed for patching.
+*   16 October, 2026: V1.7 - A patched word keeps its whole address, as appendMachineCode() does.
+======================================================================================================*/
+/*===============================================
+ *   HEADER FILES
+ *==============================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include "allocator.h"
+#include "stats.h"
+#include "watch.h"
+#include "optimizer.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+typedef struct watchEdit {
+    size_t start;           // First byte of the first changed line, the same in both texts
+    size_t old_end;         // Just past the last changed line in the old text
+    size_t new_end;         // The same place in the new text
+    int first;              // First LINE in the changed range
+    int last;               // Just past the last LINE in the changed range
+} WATCH_EDIT;
+
+/*===============================================
+*   FUNCTION    :   watch_init
+*   DESCRIPTION :   This function will create the empty state of a watched input, to be assembled at the given -O level.
+*   ARGUMENTS   :   WATCH_FILE *file, const char *input, int optimize
+*   RETURNS     :   VOID
+ *==============================================*/
+void watch_init(WATCH_FILE *file, const char *input, int optimize)
+{
+    memset(file, 0, sizeof(*file));
+    file->input = input;
+    file->optimize = optimize;
+    file->program.allocator = &heap_allocator;
+    file->code.allocator = &heap_allocator;
+    file->symbols.allocator = &heap_allocator;
+}
+
+/*===============================================
+*   FUNCTION    :   release_build
+*   DESCRIPTION :   This function will drop the lines, machine code and symbols of the last build, but keep the text.
+*   ARGUMENTS   :   WATCH_FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+static void release_build(WATCH_FILE *file)
+{
+    if (file->program.lines != NULL)
+        RELEASE(&heap_allocator, file->program.lines);
+    source_close(&file->program.source);        // Only owns a copy if -O3 rewrote lines
+    memset(&file->program, 0, sizeof(file->program));
+    file->program.allocator = &heap_allocator;
+    free(file->info);
+    file->info = NULL;
+    if (file->built)
+        freeMachineCode(&file->code);
+    if (file->symbols.slots != NULL)
+        symtab_free(&file->symbols);
+    memset(&file->symbols, 0, sizeof(file->symbols));
+    file->built = false;
+    file->patchable = false;
+}
+
+/*===============================================
+*   FUNCTION    :   watch_free
+*   DESCRIPTION :   This function will release everything kept for a watched input.
+*   ARGUMENTS   :   WATCH_FILE *file
+*   RETURNS     :   VOID
+ *==============================================*/
+void watch_free(WATCH_FILE *file)
+{
+    release_build(file);
+    free(file->text);
+    watch_init(file, file->input, file->optimize);
+}
+
+/*===============================================
+*   FUNCTION    :   index_program
+*   DESCRIPTION :   This function will record the address, instruction and operand symbol of every line of a build
+*                   without errors, and define its labels, which is what a later patch works from.
+*   ARGUMENTS   :   WATCH_FILE *file
+*   RETURNS     :   bool
+ *==============================================*/
+static bool index_program(WATCH_FILE *file)
+{
+    const PROGRAM *program = &file->program;
+    file->info = malloc((program->line_capacity > 0 ? program->line_capacity : 1) * sizeof(WATCH_LINE));
+    if (file->info == NULL || !symtab_init(&file->symbols, program->line_count, &heap_allocator))
+        return false;
+
+    unsigned int address = 0;
+    int word = 0;
+    for (int i = 0; i < program->line_count; i++) {
+        const LINE *line = &program->lines[i];
+        WATCH_LINE *info = &file->info[i];
+        info->symbol = -1;
+        if (token_equals(program, line->label, "ORG")) {
+            unsigned long origin;
+            if (!token_number(program, line->operation, &origin) || origin >= TRACS_MEMORY_SIZE)
+                return false;
+            address = (unsigned int)origin;
+            info->address = address;
+            info->word = -1;
+            continue;
+        }
+        info->address = address;
+        info->word = word++;
+        bool duplicate;
+        if (line->label.length != 0 &&
+            symtab_define(&file->symbols, token_text(program, line->label), line->label.length, address, i, &duplicate) == -1)
+            return false;
+        if (line->operand.length != 0 && !token_is_number(program, line->operand)) {
+            info->symbol = symtab_intern(&file->symbols, token_text(program, line->operand), line->operand.length);
+            if (info->symbol == -1)
+                return false;
+        }
+        address += 2;
+    }
+    return word * 2 == file->code.count;
+}
+
+/*===============================================
+*   FUNCTION    :   assemble_text
+*   DESCRIPTION :   This function will assemble the whole text from scratch, print its diagnostics, and keep the
+*                   result for later patches if it had no errors.
+*   ARGUMENTS   :   WATCH_FILE *file, char *text, size_t size
+*   RETURNS     :   bool
+ *==============================================*/
+static bool assemble_text(WATCH_FILE *file, char *text, size_t size)
+{
+    release_build(file);
+    free(file->text);
+    file->text = text;
+    file->size = size;
+
+    DIAGNOSTICS diagnostics;
+    diagnostics_init(&diagnostics, &heap_allocator);
+    diagnostics.limit = DIAGNOSTIC_LIMIT;
+    bool success = process_buffer(text, size, &heap_allocator, &file->program, &diagnostics);
+    file->relexed = file->program.line_count;
+    file->moved = 0;
+    if (success)
+        success = assemble_program(&file->program, &file->code, &diagnostics);
+    if (success && file->optimize > OPTIMIZE_NONE)
+        optimize_program(&file->program, file->optimize, &file->code, &diagnostics);
+    file->built = success;
+    file->patchable = success && file->optimize == OPTIMIZE_NONE && index_program(file);
+
+    diagnostics_sort(&diagnostics);
+    print_diagnostics(&diagnostics, file->input, stderr);
+    diagnostics_free(&diagnostics);
+    return success;
+}
+
+/*===============================================
+*   FUNCTION    :   find_edit
+*   DESCRIPTION :   This function will find the whole lines that differ between the old and the new text, from the
+*                   longest common prefix and suffix, and the LINEs that hold them.
+*   ARGUMENTS   :   const WATCH_FILE *file, const char *text, size_t size, WATCH_EDIT *edit
+*   RETURNS     :   bool (false if the texts are the same)
+ *==============================================*/
+static bool find_edit(const WATCH_FILE *file, const char *text, size_t size, WATCH_EDIT *edit)
+{
+    const char *old = file->text;
+    size_t old_size = file->size;
+    size_t common = old_size < size ? old_size : size;
+    size_t prefix = 0;
+    while (prefix < common && old[prefix] == text[prefix])
+        prefix++;
+    if (prefix == old_size && prefix == size)
+        return false;
+    size_t suffix = 0;
+    while (suffix < common - prefix && old[old_size - 1 - suffix] == text[size - 1 - suffix])
+        suffix++;
+
+    // Widen to whole lines; the suffix is the same text, so both ends move by the same amount
+    edit->start = prefix;
+    while (edit->start > 0 && old[edit->start - 1] != '\n')
+        edit->start--;
+    size_t end = old_size - suffix;
+    while (end < old_size && old[end] != '\n')
+        end++;
+    if (end < old_size)
+        end++;
+    edit->old_end = end;
+    edit->new_end = size - (old_size - end);
+
+    // LINEs are in source order and each starts at its first token
+    const LINE *lines = file->program.lines;
+    int low = 0, high = file->program.line_count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (lines[middle].label.offset < edit->start)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    edit->first = low;
+    edit->last = low;
+    while (edit->last < file->program.line_count && lines[edit->last].label.offset < edit->old_end)
+        edit->last++;
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   count_newlines
+*   DESCRIPTION :   This function will count the newlines in a stretch of text.
+*   ARGUMENTS   :   const char *text, size_t size
+*   RETURNS     :   unsigned int
+ *==============================================*/
+static unsigned int count_newlines(const char *text, size_t size)
+{
+    unsigned int count = 0;
+    const char *end = text + size;
+    while ((text = memchr(text, '\n', (size_t)(end - text))) != NULL) {
+        count++;
+        text++;
+    }
+    return count;
+}
+
+/*===============================================
+*   FUNCTION    :   patchable_line
+*   DESCRIPTION :   This function will tell whether a line can be patched in or out: it must not be ORG or EOP,
+*                   and in the new text it must also assemble without a diagnostic.
+*   ARGUMENTS   :   const PROGRAM *program, const LINE *line, const SYMTAB *symbols (NULL for a line of the old text)
+*   RETURNS     :   bool
+ *==============================================*/
+static bool patchable_line(const PROGRAM *program, const LINE *line, const SYMTAB *symbols)
+{
+    if (token_equals(program, line->label, "ORG") || token_equals(program, line->label, "EOP") ||
+        token_equals(program, line->operation, "EOP"))
+        return false;
+    if (symbols == NULL)
+        return true;
+
+    const MNEMONIC *op = mnemonic_lookup(token_text(program, line->operation), line->operation.length);
+    if (op == NULL)
+        return false;
+    if (line->operand.length == 0)
+        return true;
+    if (token_is_number(program, line->operand)) {
+        unsigned long value;
+        return token_number(program, line->operand, &value) && value <= operand_limit(op);
+    }
+    int sym = symtab_find(symbols, token_text(program, line->operand), line->operand.length);
+    return op->isBranch && sym != -1 && symbols->symbols[sym].defined;
+}
+
+/*===============================================
+*   FUNCTION    :   same_labels
+*   DESCRIPTION :   This function will tell whether two runs of lines define the same labels in the same order, so
+*                   the symbol table keeps every name and only addresses can change.
+*   ARGUMENTS   :   const PROGRAM *before, const LINE *old_lines, int old_count, const PROGRAM *after, const LINE *new_lines,
+*                   int new_count
+*   RETURNS     :   bool
+ *==============================================*/
+static bool same_labels(const PROGRAM *before, const LINE *old_lines, int old_count, const PROGRAM *after, const LINE *new_lines, int new_count)
+{
+    int i = 0, j = 0;
+    for (;;) {
+        while (i < old_count && old_lines[i].label.length == 0)
+            i++;
+        while (j < new_count && new_lines[j].label.length == 0)
+            j++;
+        if (i == old_count || j == new_count)
+            return i == old_count && j == new_count;
+        if (old_lines[i].label.length != new_lines[j].label.length ||
+            memcmp(token_text(before, old_lines[i].label), token_text(after, new_lines[j].label), old_lines[i].label.length) != 0)
+            return false;
+        i++;
+        j++;
+    }
+}
+
+/*===============================================
+*   FUNCTION    :   move_tokens
+*   DESCRIPTION :   This function will move the tokens of a line by a number of bytes (modulo 2^32, so it can move
+*                   them back). Absent fields stay at offset 0, as tokenize_program() leaves them; the label
+*                   offset always moves, since it marks the start of the line even when there is no label.
+*   ARGUMENTS   :   LINE *line, unsigned int delta
+*   RETURNS     :   VOID
+ *==============================================*/
+static void move_tokens(LINE *line, unsigned int delta)
+{
+    line->label.offset += delta;
+    if (line->operation.length != 0)
+        line->operation.offset += delta;
+    if (line->operand.length != 0)
+        line->operand.offset += delta;
+}
+
+/*===============================================
+*   FUNCTION    :   patch_word
+*   DESCRIPTION :   This function will write one instruction word into the machine code.
+*   ARGUMENTS   :   MACHINE_CODE *code, int word, unsigned int address, unsigned int value
+*   RETURNS     :   VOID
+ *==============================================*/
+static void patch_word(MACHINE_CODE *code, int word, unsigned int address, unsigned int value)
+{
+    code->bytes[2 * word].address = address;
+    code->bytes[2 * word].value = (value >> 8) & 0xFF;
+    code->bytes[2 * word + 1].address = address + 1;
+    code->bytes[2 * word + 1].value = value & 0xFF;
+}
+
+/*===============================================
+*   FUNCTION    :   patch_text
+*   DESCRIPTION :   This function will bring a build without errors up to date with an edited text without
+*                   assembling it again. Nothing is changed unless the whole edit can be patched; otherwise the
+*                   caller assembles from scratch.
+*   ARGUMENTS   :   WATCH_FILE *file, char *text, size_t size
+*   RETURNS     :   bool (true if the build now matches text)
+ *==============================================*/
+static bool patch_text(WATCH_FILE *file, char *text, size_t size)
+{
+    PROGRAM *program = &file->program;
+    WATCH_EDIT edit;
+    if (!find_edit(file, text, size, &edit)) {
+        // Saved without a change
+        free(file->text);
+        file->text = text;
+        program->source.text = text;
+        file->relexed = 0;
+        file->moved = 0;
+        return true;
+    }
+
+    // Lex only the changed lines; their offsets and numbers are relative to edit.start until moved
+    PROGRAM region;
+    DIAGNOSTICS diagnostics;
+    diagnostics_init(&diagnostics, &heap_allocator);
+    process_buffer(text + edit.start, edit.new_end - edit.start, &heap_allocator, &region, &diagnostics);
+    bool patchable = diagnostics.count == 0;
+    diagnostics_free(&diagnostics);
+
+    int old_count = edit.last - edit.first;
+    int new_count = region.line_count;
+    int delta = new_count - old_count;
+    for (int i = edit.first; patchable && i < edit.last; i++)
+        patchable = patchable_line(program, &program->lines[i], NULL);
+    for (int i = 0; patchable && i < new_count; i++)
+        patchable = patchable_line(&region, &region.lines[i], &file->symbols);
+    patchable = patchable && same_labels(program, program->lines + edit.first, old_count, &region, region.lines, new_count);
+
+    // Where the changed lines start in the address space and in the machine code
+    unsigned int address = 0;
+    int word = 0;
+    for (int i = edit.first - 1; i >= 0; i--) {
+        if (i == edit.first - 1)
+            address = file->info[i].word == -1 ? file->info[i].address : file->info[i].address + 2;
+        if (file->info[i].word != -1) {
+            word = file->info[i].word + 1;
+            break;
+        }
+    }
+
+    // Room for the longer program is the last thing that can fail
+    int line_count = program->line_count + delta;
+    if (patchable && line_count > program->line_capacity) {
+        LINE *lines = REALLOCATE(&heap_allocator, program->lines, program->line_capacity * sizeof(LINE), line_count * sizeof(LINE));
+        if (lines != NULL)
+            program->lines = lines;
+        WATCH_LINE *info = lines != NULL ? realloc(file->info, line_count * sizeof(WATCH_LINE)) : NULL;
+        if (info != NULL) {
+            file->info = info;
+            program->line_capacity = line_count;
+        }
+        patchable = info != NULL;
+    }
+    if (patchable && file->code.count + 2 * delta > file->code.capacity) {
+        int capacity = file->code.count + 2 * delta;
+        MACHINE_BYTE *bytes = REALLOCATE(&heap_allocator, file->code.bytes, file->code.capacity * sizeof(MACHINE_BYTE), capacity * sizeof(MACHINE_BYTE));
+        if (bytes != NULL) {
+            file->code.bytes = bytes;
+            file->code.capacity = capacity;
+        }
+        patchable = bytes != NULL;
+    }
+    unsigned char *moved = patchable ? calloc(file->symbols.count > 0 ? file->symbols.count : 1, 1) : NULL;
+    if (moved == NULL) {
+        free_program(&region);
+        return false;
+    }
+
+    // Make room for the new lines and instructions, then move everything after them
+    const LINE *lines = program->lines;
+    size_t from = edit.first > 0 ? lines[edit.first - 1].label.offset : 0;
+    unsigned int number = (edit.first > 0 ? lines[edit.first - 1].number : 1) + count_newlines(file->text + from, edit.start - from);
+    int number_delta = (int)count_newlines(text + edit.start, edit.new_end - edit.start) -
+                       (int)count_newlines(file->text + edit.start, edit.old_end - edit.start);
+    unsigned int offset_delta = (unsigned int)(size - file->size);
+    int tail = program->line_count - edit.last;
+    memmove(program->lines + edit.first + new_count, program->lines + edit.last, tail * sizeof(LINE));
+    memmove(file->info + edit.first + new_count, file->info + edit.last, tail * sizeof(WATCH_LINE));
+    memmove(file->code.bytes + 2 * (word + new_count), file->code.bytes + 2 * (word + old_count),
+            (file->code.count - 2 * (word + old_count)) * sizeof(MACHINE_BYTE));
+    program->line_count = line_count;
+    program->source.text = text;
+    program->source.size = size;
+    file->code.count += 2 * delta;
+    free(file->text);
+    file->text = text;
+    file->size = size;
+
+    bool shifting = delta != 0;
+    for (int i = edit.first + new_count; i < line_count; i++) {
+        LINE *line = &program->lines[i];
+        WATCH_LINE *info = &file->info[i];
+        move_tokens(line, offset_delta);
+        line->number += number_delta;
+        if (info->word == -1) {
+            // Code after an ORG does not move
+            shifting = false;
+            continue;
+        }
+        info->word += delta;
+        if (!shifting)
+            continue;
+        info->address += 2 * delta;
+        file->code.bytes[2 * info->word].address += 2 * delta;
+        file->code.bytes[2 * info->word + 1].address += 2 * delta;
+        if (line->label.length != 0) {
+            int sym = symtab_find(&file->symbols, token_text(program, line->label), line->label.length);
+            file->symbols.symbols[sym].address = info->address;
+            moved[sym] = 1;
+        }
+    }
+
+    // Encode the changed lines; their label operands are resolved once every label has moved
+    for (int i = 0; i < new_count; i++) {
+        LINE *line = &program->lines[edit.first + i];
+        WATCH_LINE *info = &file->info[edit.first + i];
+        *line = region.lines[i];
+        move_tokens(line, (unsigned int)edit.start);
+        line->number += number - 1;
+        info->address = address + 2 * i;
+        info->word = word + i;
+        info->symbol = -1;
+
+        const MNEMONIC *op = mnemonic_lookup(token_text(program, line->operation), line->operation.length);
+        unsigned long operand = 0;
+        if (line->operand.length != 0 && token_is_number(program, line->operand))
+            token_number(program, line->operand, &operand);
+        else if (line->operand.length != 0)
+            info->symbol = symtab_find(&file->symbols, token_text(program, line->operand), line->operand.length);
+        patch_word(&file->code, info->word, info->address, encode_instruction(op, operand));
+        if (line->label.length != 0) {
+            int sym = symtab_find(&file->symbols, token_text(program, line->label), line->label.length);
+            if (file->symbols.symbols[sym].address != info->address) {
+                file->symbols.symbols[sym].address = info->address;
+                moved[sym] = 1;
+            }
+        }
+    }
+
+    // Resolve the uses of labels that moved, and every label operand of the changed lines
+    file->moved = 0;
+    for (int sym = 0; sym < file->symbols.count; sym++)
+        file->moved += moved[sym];
+    int low = file->moved != 0 ? 0 : edit.first;
+    int high = file->moved != 0 ? line_count : edit.first + new_count;
+    for (int i = low; i < high; i++) {
+        const WATCH_LINE *info = &file->info[i];
+        bool changed = i >= edit.first && i < edit.first + new_count;
+        if (info->symbol == -1 || !(changed || moved[info->symbol]))
+            continue;
+        encode_target(&file->code, info->word, file->symbols.symbols[info->symbol].address);
+    }
+
+    // The only diagnostic a build without errors can have is the warning for the first line past the address space
+    diagnostics_init(&diagnostics, &heap_allocator);
+    for (int i = 0; i < line_count; i++) {
+        const LINE *line = &program->lines[i];
+        if (file->info[i].word != -1 && file->info[i].address >= TRACS_MEMORY_SIZE) {
+            report_at(&diagnostics, TRACS_WARNING, line->number, token_column(program, line->label.length != 0 ? line->label : line->operation),
+                      "Address 0x%03x is outside the 11-bit address space", file->info[i].address);
+            break;
+        }
+    }
+    print_diagnostics(&diagnostics, file->input, stderr);
+    diagnostics_free(&diagnostics);
+
+    file->relexed = new_count;
+    free(moved);
+    free_program(&region);
+    return true;
+}
+
+/*===============================================
+*   FUNCTION    :   watch_build
+*   DESCRIPTION :   This function will read the input again and bring its build up to date, patching the edit in
+*                   when it can and assembling from scratch otherwise. Diagnostics go to stderr.
+*   ARGUMENTS   :   WATCH_FILE *file, bool *patched (set if the edit was patched in)
+*   RETURNS     :   bool (true if the input now assembles)
+ *==============================================*/
+bool watch_build(WATCH_FILE *file, bool *patched)
+{
+    *patched = false;
+    SOURCE source;
+    if (!source_open(file->input, &source)) {
+        fprintf(stderr, "%s: error: Cannot open file: %s\n", file->input, strerror(errno));
+        return false;
+    }
+
+    // Keep a copy: a mapping would change under the tokens when the file is written in place
+    char *text = malloc(source.size > 0 ? source.size : 1);
+    if (text == NULL) {
+        source_close(&source);
+        fprintf(stderr, "%s: error: Memory allocation failed\n", file->input);
+        return false;
+    }
+    memcpy(text, source.text, source.size);
+    size_t size = source.size;
+    source_close(&source);
+
+    if (file->patchable && size <= UINT_MAX && patch_text(file, text, size)) {
+        *patched = true;
+        return true;
+    }
+    return assemble_text(file, text, size);
+}
+
+/*===============================================
+*   FUNCTION    :   rebuild
+*   DESCRIPTION :   This function will rebuild one input, report how it went and hand new code to the callback.
+*   ARGUMENTS   :   WATCH_FILE *file, bool quiet, WATCH_CALLBACK built, void *context
+*   RETURNS     :   VOID
+ *==============================================*/
+static void rebuild(WATCH_FILE *file, bool quiet, WATCH_CALLBACK built, void *context)
+{
+    bool patched;
+    double started = stats_now();
+    bool success = watch_build(file, &patched);
+    double seconds = stats_now() - started;
+    if (!success) {
+        fprintf(stderr, "%s: Assembly failed!\n", file->input);
+        return;
+    }
+    if (patched && file->relexed == 0)
+        return;
+    if (!quiet) {
+        if (patched)
+            fprintf(stderr, "%s: patched %d line%s, %d label%s moved (%.3f ms)\n", file->input, file->relexed,
+                    file->relexed == 1 ? "" : "s", file->moved, file->moved == 1 ? "" : "s", seconds * 1e3);
+        else
+            fprintf(stderr, "%s: assembled %d lines (%.3f ms)\n", file->input, file->relexed, seconds * 1e3);
+    }
+    built(file->input, &file->code, context);
+}
+
+#ifdef __linux__
+/*===============================================
+*   FUNCTION    :   wait_for_changes
+*   DESCRIPTION :   This function will block until a watched input is written or replaced, then wait for the
+*                   writes to settle and mark every input that changed. Directories are watched rather than
+*                   the files, so editors that save by renaming a new file into place are seen too.
+*   ARGUMENTS   :   int fd, const int *watches, WATCH_FILE *files, bool *changed, int count
+*   RETURNS     :   bool (false if inotify failed)
+ *==============================================*/
+static bool wait_for_changes(int fd, const int *watches, WATCH_FILE *files, bool *changed, int count)
+{
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int timeout = -1;
+    for (;;) {
+        struct pollfd poller = { fd, POLLIN, 0 };
+        int ready = poll(&poller, 1, timeout);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready < 0)
+            return false;
+        if (ready == 0)
+            return true;
+
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR)
+            continue;
+        if (length <= 0)
+            return false;
+        for (char *p = buffer; p < buffer + length; ) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            for (int i = 0; i < count; i++) {
+                const char *name = strrchr(files[i].input, '/');
+                name = name != NULL ? name + 1 : files[i].input;
+                if (watches[i] == event->wd && event->len != 0 && strcmp(event->name, name) == 0) {
+                    changed[i] = true;
+                    timeout = WATCH_SETTLE_MS;
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+#else
+/*===============================================
+*   FUNCTION    :   wait_for_changes
+*   DESCRIPTION :   This function will poll the modification time and size of every input until one changes.
+*   ARGUMENTS   :   struct stat *seen, WATCH_FILE *files, bool *changed, int count
+*   RETURNS     :   bool
+ *==============================================*/
+static bool wait_for_changes(struct stat *seen, WATCH_FILE *files, bool *changed, int count)
+{
+    for (;;) {
+#ifdef _WIN32
+        Sleep(WATCH_POLL_MS);
+#else
+        struct timespec pause = { 0, WATCH_POLL_MS * 1000000L };
+        nanosleep(&pause, NULL);
+#endif
+        bool any = false;
+        for (int i = 0; i < count; i++) {
+            struct stat now;
+            if (stat(files[i].input, &now) == 0 && (now.st_mtime != seen[i].st_mtime || now.st_size != seen[i].st_size)) {
+                seen[i] = now;
+                changed[i] = any = true;
+            }
+        }
+        if (any)
+            return true;
+    }
+}
+#endif
+
+/*===============================================
+*   FUNCTION    :   watch_run
+*   DESCRIPTION :   This function will assemble every input, then keep reassembling the ones that change until the
+*                   process is stopped. built is called with the machine code after every successful build.
+*   ARGUMENTS   :   const char **inputs, int input_count, int optimize, bool quiet, WATCH_CALLBACK built, void *context
+*   RETURNS     :   int (only returns if watching could not start or failed)
+ *==============================================*/
+int watch_run(const char **inputs, int input_count, int optimize, bool quiet, WATCH_CALLBACK built, void *context)
+{
+    WATCH_FILE *files = malloc(input_count * sizeof(WATCH_FILE));
+    bool *changed = calloc(input_count, sizeof(bool));
+#ifdef __linux__
+    int *watches = malloc(input_count * sizeof(int));
+    int fd = inotify_init1(IN_CLOEXEC);
+    bool started = files != NULL && changed != NULL && watches != NULL && fd != -1;
+#else
+    struct stat *seen = calloc(input_count, sizeof(struct stat));
+    bool started = files != NULL && changed != NULL && seen != NULL;
+#endif
+    for (int i = 0; started && i < input_count; i++) {
+        watch_init(&files[i], inputs[i], optimize);
+#ifdef __linux__
+        // Watch the directory, so a file saved by rename keeps being watched
+        const char *slash = strrchr(inputs[i], '/');
+        char directory[PATH_MAX];
+        if (slash == NULL)
+            strcpy(directory, ".");
+        else
+            snprintf(directory, sizeof(directory), "%.*s", slash == inputs[i] ? 1 : (int)(slash - inputs[i]), inputs[i]);
+        watches[i] = inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watches[i] == -1) {
+            fprintf(stderr, "%s: Cannot watch %s: %s\n", inputs[i], directory, strerror(errno));
+            started = false;
+        }
+#else
+        stat(inputs[i], &seen[i]);
+#endif
+    }
+
+    if (started) {
+        for (int i = 0; i < input_count; i++)
+            rebuild(&files[i], quiet, built, context);
+        if (!quiet)
+            fprintf(stderr, "Watching %d input%s for changes (Ctrl+C to stop)\n", input_count, input_count == 1 ? "" : "s");
+#ifdef __linux__
+        while (wait_for_changes(fd, watches, files, changed, input_count)) {
+#else
+        while (wait_for_changes(seen, files, changed, input_count)) {
+#endif
+            for (int i = 0; i < input_count; i++) {
+                if (changed[i])
+                    rebuild(&files[i], quiet, built, context);
+                changed[i] = false;
+            }
+        }
+        fprintf(stderr, "Watching stopped: %s\n", strerror(errno));
+        for (int i = 0; i < input_count; i++)
+            watch_free(&files[i]);
+    }
+    else
+        fprintf(stderr, "Could not start watching the inputs\n");
+
+#ifdef __linux__
+    if (fd != -1)
+        close(fd);
+    free(watches);
+#else
+    free(seen);
+#endif
+    free(files);
+    free(changed);
+    return 1;
+}
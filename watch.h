@@ -0,0 +1,51 @@
+#ifndef WATCH_H
+#define WATCH_H
+/*===============================================
+ *   STRUCTS & DEFINITIONS
+ *==============================================*/
+#include <stdbool.h>
+#include "assembler.h"
+
+#define WATCH_SETTLE_MS     50      // Quiet time after a change before reassembling, so saves are not seen half-written
+#define WATCH_POLL_MS       250     // Interval of the stat() fallback where inotify is not available
+
+typedef struct watchLine {
+    unsigned int address;   // Address of the instruction, or the new location counter of an ORG line
+    int word;               // Index of the line's instruction in code, -1 for ORG
+    int symbol;             // Symbol named by the operand, -1 if the operand is not a label
+} WATCH_LINE;
+
+/*
+ * Everything one assembly of a watched file produced, kept resident between changes. While the last
+ * build had no errors, an edit is patched in: only the changed lines are lexed and encoded, the lines
+ * after them are moved, and only the uses of labels whose address moved are resolved again. Anything the
+ * patch cannot prove unchanged (an error, ORG, EOP, a label added or removed) falls back to a full
+ * assembly.
+ */
+typedef struct watchFile {
+    const char *input;
+    char *text;             // Resident copy of the source the tokens point into
+    size_t size;
+    PROGRAM program;
+    WATCH_LINE *info;       // One per line of program, with the same capacity
+    MACHINE_CODE code;
+    SYMTAB symbols;         // Label addresses; SYMBOL.line is not kept up to date by patches
+    bool built;             // code holds the result of the last build
+    bool patchable;         // The last build had no errors, so the next edit may be patched in
+    int relexed;            // Lines lexed by the last build
+    int moved;              // Labels whose address the last patch changed
+    int optimize;           // -O level; optimized builds are never patched, their lines no longer match the text
+} WATCH_FILE;
+
+// Called after every successful build with the new machine code
+typedef bool (*WATCH_CALLBACK)(const char *input, const MACHINE_CODE *code, void *context);
+
+/*===============================================
+ *   FUNCTION PROTOTYPES
+ *==============================================*/
+void watch_init(WATCH_FILE *file, const char *input, int optimize);
+bool watch_build(WATCH_FILE *file, bool *patched);
+void watch_free(WATCH_FILE *file);
+int watch_run(const char **inputs, int input_count, int optimize, bool quiet, WATCH_CALLBACK built, void *context);
+
+#endif